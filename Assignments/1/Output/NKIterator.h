@@ -5,6 +5,8 @@
 #include <iostream>
 #include <tuple>
 #include <memory>
+#include <iterator>
+#include <type_traits>
 #include "Utility.h"
 
 using namespace std;
@@ -12,12 +14,61 @@ using namespace std;
 template <class T>
 class NKTensor;
 
+/**
+ * Iterator over all the elements of a tensor, in right-major order.
+ * NKIterator<T> writes the elements, NKIterator<const T> only reads them and is
+ * the one returned by begin() and end() on const tensors
+ */
 template<class T>
 class NKIterator{
+public:
+    // maximum rank of a tensor whose tupla is kept in the iterator itself, so that copies do not touch the heap
+    static constexpr int MAX_RANK = 8;
+
 private:
-    friend class NKTensor<T>;
-    const NKTensor<T>* tensor_; // reference to the tensor_ that has  to be iterated
-    vector<int> cur_ref_; // tupla of the next element to be read
+    typedef typename remove_const<T>::type Element_;
+    friend class NKTensor<Element_>;
+    friend class NKIterator<const Element_>;
+    const NKTensor<Element_>* tensor_; // reference to the tensor_ that has  to be iterated
+    Index inline_ref_[MAX_RANK]; // tupla of the next element to be read
+    unique_ptr<Index[]> large_ref_; // used instead of inline_ref_ when the rank is greater than MAX_RANK
+    T* ptr_; // element pointed by the tupla, moved along with it by strides
+    ptrdiff_t pos_; // position of the element in the iteration order
+
+    /**
+     * Tupla of the next element to be read
+     * @return pointer to the first index of the tupla
+     */
+    inline Index* tupla(){
+        return large_ref_ ? large_ref_.get() : inline_ref_;
+    }
+
+    inline const Index* tupla() const{
+        return large_ref_ ? large_ref_.get() : inline_ref_;
+    }
+
+    /**
+     * Rank of the iterated tensor
+     * @return rank, 0 for singular iterators
+     */
+    inline int rank() const{
+        return tensor_ == nullptr ? 0 : (int)tensor_->rank_;
+    }
+
+    /**
+     * Replace the tupla with a copy of another one, of the same rank as the iterated tensor
+     * @param tupla : tupla to be copied
+     */
+    void copyTupla(const Index tupla[]){
+        Index* dest = inline_ref_;
+        large_ref_.reset();
+        if(rank() > MAX_RANK){
+            large_ref_.reset(new Index[rank()]);
+            dest = large_ref_.get();
+        }
+        for(int i = 0; i < rank(); ++i)
+            dest[i] = tupla[i];
+    }
 
     /**
      * Private Costructor
@@ -25,28 +76,69 @@ private:
      * @param start : true for begin iterator, false otherwise
      * @return the begin iterator on tensor_ if start = true, the end iterator otherwise
      */
-    NKIterator(const NKTensor<T>& ten, bool start) : tensor_(&ten), cur_ref_((int)ten.rank_){
+    NKIterator(const NKTensor<Element_>& ten, bool start) : tensor_(&ten){
         if(ten.rank_ == 0)
             throw invalid_argument("Unsupported operation on tensor with rank 0");
+        if(ten.rank_ > MAX_RANK)
+            large_ref_.reset(new Index[ten.rank_]);
+        Index* cur_ref_ = tupla();
+        for(int i = 0; i < ten.rank_; ++i)
+            cur_ref_[i] = 0;
+        ptr_ = ten.array_->data() + ten.start_pointer_;
+        pos_ = 0;
         if(!start){
             cur_ref_[0] = ten.dimensions_.at(0);
+            ptr_ += ten.strides_[0] * ten.dimensions_[0];
+            pos_ = 1;
+            for(int i = 0; i < ten.rank_; ++i)
+                pos_ *= ten.dimensions_[i];
+        }
+    }
+
+    /**
+     * Recompute tupla and pointer from the position in the iteration order, for random access
+     */
+    void seek(){
+        Index* cur_ref_ = tupla();
+        difference_type rest = pos_;
+        ptr_ = tensor_->array_->data() + tensor_->start_pointer_;
+        for(int i = (int)tensor_->rank_ - 1; i > 0; --i){
+            cur_ref_[i] = rest % tensor_->dimensions_[i];
+            rest /= tensor_->dimensions_[i];
+            ptr_ += tensor_->strides_[i] * cur_ref_[i];
         }
+        // the first index is not wrapped around, as in operator++
+        cur_ref_[0] = rest;
+        ptr_ += tensor_->strides_[0] * rest;
     }
 
 public:
+    // random access iterator traits, so that standard algorithms can run over tensors
+    typedef random_access_iterator_tag iterator_category;
+    typedef Element_ value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    /**
+     * Default constructor
+     * @return singular iterator, to be assigned before use
+     */
+    NKIterator() : tensor_(nullptr), ptr_(nullptr), pos_(0) {}
+
     /**
      * It only shows the current tupla
      */
     void show(){
-        showVector(cur_ref_);
+        showVector(tupla(), rank());
     }
 
     /**
      * For tensor copy
      * @return copy of the internal tupla
      */
-    vector<int> currentPosition(){
-        return cur_ref_;
+    vector<Index> currentPosition(){
+        return vector<Index>(tupla(), tupla() + rank());
     }
 
     /**
@@ -54,7 +146,9 @@ public:
      * @param ite : is the iterator to be copied
      * @return new iterator that is a copy of ite
      */
-    NKIterator(const NKIterator& ite) = default;
+    NKIterator(const NKIterator& ite) : tensor_(ite.tensor_), ptr_(ite.ptr_), pos_(ite.pos_) {
+        copyTupla(ite.tupla());
+    }
 
     /**
      * Move constructor
@@ -63,6 +157,16 @@ public:
      */
     NKIterator(NKIterator&& ite) = default;
 
+    /**
+     * Conversion to a read-only iterator
+     * @param ite : writing iterator to be converted
+     * @return read-only iterator on the same element
+     */
+    template<class U, class = typename enable_if<is_same<const U, T>::value && !is_same<U, T>::value>::type>
+    NKIterator(const NKIterator<U>& ite) : tensor_(ite.tensor_), ptr_(ite.ptr_), pos_(ite.pos_) {
+        copyTupla(ite.tupla());
+    }
+
     /**
      * Destructor
      */
@@ -73,7 +177,15 @@ public:
      * @param ite : is the iterator to be copied
      * @return the reference to the operator assigned
      */
-    NKIterator& operator=(const NKIterator& ite) = default;
+    NKIterator& operator=(const NKIterator& ite){
+        if(this != &ite){
+            tensor_ = ite.tensor_;
+            ptr_ = ite.ptr_;
+            pos_ = ite.pos_;
+            copyTupla(ite.tupla());
+        }
+        return *this;
+    }
 
     /**
      * Move Assignment
@@ -87,41 +199,105 @@ public:
      * @return reference to the updated iterator
      */
     NKIterator& operator++ (){
-        int max_dim = cur_ref_[0];
-        bool updated = false;
+        Index* cur_ref_ = tupla();
         int i = (int)tensor_->rank_ - 1;
-        while(!updated && i >= 0 ){
-            if(cur_ref_[i] == tensor_->dimensions_.at(i)-1){
-                cur_ref_[i]=0;
-                --i;
-            }
-            else{
-                ++cur_ref_[i];
-                updated = true;
-            }
-        }
-        if(!updated){
-            cur_ref_[0] = max_dim + 1;
+        while(i > 0 && cur_ref_[i] == tensor_->dimensions_[i]-1){
+            cur_ref_[i] = 0;
+            ptr_ -= tensor_->strides_[i] * (tensor_->dimensions_[i]-1);
+            --i;
         }
+        // the first index is not wrapped around, so that the last element is followed by the end iterator
+        ++cur_ref_[i];
+        ptr_ += tensor_->strides_[i];
+        ++pos_;
         return *this;
     }
 
     /**
      * Postfix ++ operator
      * @param n : imposed to 1
-     * @return
+     * @return copy of the iterator before the increment
      */
     NKIterator operator++(const int n){
-        return ++(*this);
+        NKIterator old(*this);
+        ++(*this);
+        return old;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to the updated iterator
+     */
+    NKIterator& operator-- (){
+        Index* cur_ref_ = tupla();
+        int i = (int)tensor_->rank_ - 1;
+        while(i > 0 && cur_ref_[i] == 0){
+            cur_ref_[i] = tensor_->dimensions_[i]-1;
+            ptr_ += tensor_->strides_[i] * (tensor_->dimensions_[i]-1);
+            --i;
+        }
+        --cur_ref_[i];
+        ptr_ -= tensor_->strides_[i];
+        --pos_;
+        return *this;
     }
 
     /**
-     * Equality comparison
+     * Postfix -- operator
+     * @param n : imposed to 1
+     * @return copy of the iterator before the decrement
+     */
+    NKIterator operator--(const int n){
+        NKIterator old(*this);
+        --(*this);
+        return old;
+    }
+
+    /**
+     * Random access
+     * @param n : number of elements to be skipped, also negative
+     * @return reference to the updated iterator
+     */
+    NKIterator& operator+= (const difference_type n){
+        pos_ += n;
+        seek();
+        return *this;
+    }
+
+    NKIterator& operator-= (const difference_type n){
+        return *this += -n;
+    }
+
+    NKIterator operator+ (const difference_type n) const{
+        NKIterator result(*this);
+        return result += n;
+    }
+
+    friend NKIterator operator+ (const difference_type n, const NKIterator& ite){
+        return ite + n;
+    }
+
+    NKIterator operator- (const difference_type n) const{
+        NKIterator result(*this);
+        return result -= n;
+    }
+
+    /**
+     * Distance between iterators on the same tensor
+     * @param ite : iterator to be subtracted from this
+     * @return number of elements from ite to this
+     */
+    difference_type operator- (const NKIterator& ite) const{
+        return pos_ - ite.pos_;
+    }
+
+    /**
+     * Equality comparison, by position in the iteration order as the other comparisons
      * @param ite : iterator to be compared with this
      * @return true if they point to the same element in tensor_
      */
-    bool operator== (const NKIterator& ite){
-        return tensor_->calculatePosition(cur_ref_) == tensor_->calculatePosition(ite.cur_ref_);
+    bool operator== (const NKIterator& ite) const{
+        return pos_ == ite.pos_;
     }
 
     /**
@@ -129,24 +305,50 @@ public:
      * @param ite : iterator to be compared with this
      * @return true if they don't point to the same element in tensor_
      */
-    bool operator!= (const NKIterator& ite){
-        return tensor_->calculatePosition(cur_ref_) != tensor_->calculatePosition(ite.cur_ref_);
+    bool operator!= (const NKIterator& ite) const{
+        return pos_ != ite.pos_;
+    }
+
+    /**
+     * Ordering comparisons, by position in the iteration order
+     * @param ite : iterator to be compared with this
+     * @return
+     */
+    bool operator< (const NKIterator& ite) const{
+        return pos_ < ite.pos_;
+    }
+
+    bool operator> (const NKIterator& ite) const{
+        return pos_ > ite.pos_;
+    }
+
+    bool operator<= (const NKIterator& ite) const{
+        return pos_ <= ite.pos_;
+    }
+
+    bool operator>= (const NKIterator& ite) const{
+        return pos_ >= ite.pos_;
     }
 
     /**
      * Dereference operator
-     * @return the value of type T pointed
+     * @return reference to the element pointed, that can be written through a writing iterator
      */
-    T operator* () {
-        try{
-            return tensor_->get(cur_ref_);
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
-        catch (out_of_range e){
-            throw e;
-        }
+    T& operator* () const{
+        return *ptr_;
+    }
+
+    T* operator-> () const{
+        return ptr_;
+    }
+
+    /**
+     * Subscript operator
+     * @param n : distance from the current element
+     * @return reference to the element n positions after the current one
+     */
+    T& operator[] (const difference_type n) const{
+        return *(*this + n);
     }
 
 };
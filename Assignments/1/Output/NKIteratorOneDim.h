@@ -5,6 +5,7 @@
 #include <iostream>
 #include <tuple>
 #include <memory>
+#include <iterator>
 #include "Utility.h"
 
 using namespace std;
@@ -12,80 +13,43 @@ using namespace std;
 template <class T>
 class NKTensor;
 
+/*Iterator along one index of a tensor, the other indexes being fixed. Elements along an index are a fixed stride apart
+in memory, so the iterator is the first element of the line and a position along it, with random access in O(1).
+Keeping the position, rather than a pointer moved by the stride, lets the end iterator stand one element past the line
+without forming a pointer outside the array.
+NKIteratorOneDim<const T> only reads the elements and is the one returned by begin(idx, ...) and end(idx, ...) on const tensors*/
 template<class T>
 class NKIteratorOneDim {
 private:
-    friend class NKTensor<T>;
-    const NKTensor<T>* tensor_; // reference to the tensor_ that has  to be iterated
-    vector<int> cur_ref_; // tupla of the next element to be read
-    int idx_to_scan_;
-
-    /**
-     * Check value for begin Iterator on only one dimension
-     * @param idx dimension to iterate
-     * @param fixed_values : fixed values of other dimensionsl,,
-     * @return
-     */
-    void checkOnDimIterator(const int idx, vector<int>& fixed_values){
-        if(idx < 0 || idx >= tensor_->rank_)
-            throw out_of_range("Index to scan doesn't exist.");
-        if(fixed_values.size() != tensor_->rank_ - 1)
-            throw invalid_argument("Indexes number not equal to rank - 1.");
-        for(int i = 0; i< tensor_->rank_; ++i) {
-            if(i != idx){
-                if(i < idx) {
-                    if (fixed_values.at(i) < 0 || fixed_values.at(i) >= tensor_->dimensions_.at(i)) {
-                        throw out_of_range("Indexes out of range");
-                    }
-                }
-                else {
-                    if (fixed_values.at(i - 1) < 0 || fixed_values.at(i - 1) >= tensor_->dimensions_.at(i)) {
-                        throw out_of_range("Indexes out of range");
-                    }
-                }
-            }
-        }
-        fixed_values.insert(fixed_values.begin() + idx, 0);
-    }
+    typedef typename remove_const<T>::type Element_;
+    friend class NKTensor<Element_>;
+    friend class NKIteratorOneDim<const Element_>;
+    T* base_; // first element of the line
+    Index stride_; // distance between two elements along the scanned index
+    Index pos_; // position of the element pointed along the line
 
     /**
      * Private Costructor
-     * @param ten : tensor_ to be iterated
-     * @param start : true for begin iterator, false otherwise
-     * @return the begin iterator on tensor_ if start = true, the end iterator otherwise
-     */
-    NKIteratorOneDim(const NKTensor<T>& ten, const bool start, const int idx, const vector<int>& fixed_values) :
-            tensor_(&ten),
-            cur_ref_(fixed_values),
-            idx_to_scan_(idx)
-    {
-        try{
-            if(ten.rank_ == 0)
-                throw invalid_argument("Unsupported operation on tensor with rank 0");
-            checkOnDimIterator(idx, cur_ref_);
-            if(!start){
-                cur_ref_[idx] = ten.dimensions_.at(idx);
-            }
-        }
-        catch (out_of_range e){
-            throw out_of_range("Index out of range. No possible operations.");
-        }
-        catch (invalid_argument e){
-            throw invalid_argument("Invalid argument. No possible operations.");
-        }
-    }
+     * @param base : first element of the line
+     * @param stride : stride of the scanned index
+     * @param pos : position of the element to be pointed
+     * @return iterator on the element pos along the line
+     */
+    NKIteratorOneDim(T* base, const Index stride, const Index pos) : base_(base), stride_(stride), pos_(pos) {}
 
 public:
+    // random access iterator traits, so that standard algorithms can run along an index
+    typedef random_access_iterator_tag iterator_category;
+    typedef Element_ value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
     /**
-     * It only shows the current tupla
+     * Default constructor
+     * @return singular iterator, to be assigned before use
      */
-    void show(){
-        showVector(cur_ref_);
-    }
-
-    vector<int> currentPosition(){
-        return cur_ref_;
-    }
+    NKIteratorOneDim() : base_(nullptr), stride_(1), pos_(0) {}
 
     /**
      * Copy constructor
@@ -101,6 +65,14 @@ public:
      */
     NKIteratorOneDim(NKIteratorOneDim&& ite) = default;
 
+    /**
+     * Conversion to a read-only iterator
+     * @param ite : writing iterator to be converted
+     * @return read-only iterator on the same element
+     */
+    template<class U, class = typename enable_if<is_same<const U, T>::value && !is_same<U, T>::value>::type>
+    NKIteratorOneDim(const NKIteratorOneDim<U>& ite) : base_(ite.base_), stride_(ite.stride_), pos_(ite.pos_) {}
+
     /**
      * Destructor
      */
@@ -125,45 +97,137 @@ public:
      * @return reference to the updated iterator
      */
     NKIteratorOneDim& operator++ (){
-        cur_ref_.at(idx_to_scan_)++;
+        ++pos_;
         return *this;
     }
 
     /**
      * Postfix ++ operator
      * @param n : imposed to 1
-     * @return
+     * @return copy of the iterator before the increment
      */
     NKIteratorOneDim operator++(const int n){
-        return ++(*this);
+        NKIteratorOneDim old(*this);
+        ++pos_;
+        return old;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to the updated iterator
+     */
+    NKIteratorOneDim& operator-- (){
+        --pos_;
+        return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @param n : imposed to 1
+     * @return copy of the iterator before the decrement
+     */
+    NKIteratorOneDim operator--(const int n){
+        NKIteratorOneDim old(*this);
+        --pos_;
+        return old;
+    }
+
+    /**
+     * Random access
+     * @param n : number of elements to be skipped, also negative
+     * @return reference to the updated iterator
+     */
+    NKIteratorOneDim& operator+= (const difference_type n){
+        pos_ += n;
+        return *this;
+    }
+
+    NKIteratorOneDim& operator-= (const difference_type n){
+        pos_ -= n;
+        return *this;
+    }
+
+    NKIteratorOneDim operator+ (const difference_type n) const{
+        return NKIteratorOneDim(base_, stride_, pos_ + n);
+    }
+
+    friend NKIteratorOneDim operator+ (const difference_type n, const NKIteratorOneDim& ite){
+        return ite + n;
+    }
+
+    NKIteratorOneDim operator- (const difference_type n) const{
+        return NKIteratorOneDim(base_, stride_, pos_ - n);
+    }
+
+    /**
+     * Distance between iterators along the same index
+     * @param ite : iterator to be subtracted from this
+     * @return number of elements from ite to this
+     */
+    difference_type operator- (const NKIteratorOneDim& ite) const{
+        return pos_ - ite.pos_;
     }
 
     /**
      * Equality comparison
      * @param ite : iterator to be compared with this
-     * @return true if they point to the same element in tensor_
+     * @return true if they point to the same element
      */
-    bool operator== (const NKIteratorOneDim& ite){
-        return tensor_->calculatePosition(cur_ref_) == tensor_->calculatePosition(ite.cur_ref_);
+    bool operator== (const NKIteratorOneDim& ite) const{
+        return pos_ == ite.pos_;
     }
 
     /**
      * Disequality comparison
      * @param ite : iterator to be compared with this
-     * @return true if they don't point to the same element in tensor_
+     * @return true if they don't point to the same element
+     */
+    bool operator!= (const NKIteratorOneDim& ite) const{
+        return pos_ != ite.pos_;
+    }
+
+    /**
+     * Ordering comparisons, by position along the line
+     * @param ite : iterator to be compared with this
+     * @return
      */
-    bool operator!= (const NKIteratorOneDim& ite){
-        return tensor_->calculatePosition(cur_ref_) != tensor_->calculatePosition(ite.cur_ref_);
+    bool operator< (const NKIteratorOneDim& ite) const{
+        return pos_ < ite.pos_;
+    }
+
+    bool operator> (const NKIteratorOneDim& ite) const{
+        return pos_ > ite.pos_;
+    }
+
+    bool operator<= (const NKIteratorOneDim& ite) const{
+        return pos_ <= ite.pos_;
+    }
+
+    bool operator>= (const NKIteratorOneDim& ite) const{
+        return pos_ >= ite.pos_;
     }
 
     /**
      * Dereference operator
-     * @return the value of type T pointed
+     * @return reference to the element pointed, that can be written
+     */
+    T& operator* () const{
+        return base_[pos_ * stride_];
+    }
+
+    T* operator-> () const{
+        return base_ + pos_ * stride_;
+    }
+
+    /**
+     * Subscript operator
+     * @param n : distance from the current element
+     * @return reference to the element n positions after the current one
      */
-    T operator* () {
-        return tensor_->get(cur_ref_);
+    T& operator[] (const difference_type n) const{
+        return base_[(pos_ + n) * stride_];
     }
-   
+
 };
 
 
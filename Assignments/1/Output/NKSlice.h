@@ -0,0 +1,251 @@
+#ifndef TENSORLIBRARY_NKSLICE_H
+#define TENSORLIBRARY_NKSLICE_H
+
+#include <vector>
+#include <memory>
+#include "Utility.h"
+
+using namespace std;
+
+template <class T>
+class NKTensor;
+
+/*Lightweight view returned by NKTensor::operator[]. The view keeps a pointer to its first element and a copy of the
+dimensions and strides left free by the slicing, in fixed-size arrays: a chain like tensor[r][c] does not touch the heap,
+and the view is not affected if the tensor is later reassigned. Only views with more than MAX_RANK free indexes keep
+their shape on the heap. Slicing a const tensor gives a read-only view,
+NKSlice<const T>. The view does not own the elements, so it must not outlive them; use copy() to keep them.*/
+template<class T>
+class NKSlice {
+public:
+    // maximum rank of a view whose shape is kept in the view itself
+    static constexpr int MAX_RANK = 8;
+
+private:
+    typedef remove_const_t<T> Element_;
+    friend class NKTensor<Element_>;
+    friend class NKSlice<Element_>;
+    T* data_; // first element of the view
+    int rank_;
+    Index shape_[2 * MAX_RANK]; // dimensions followed by strides
+    shared_ptr<Index[]> large_shape_; // used instead of shape_ when rank_ > MAX_RANK, never updated once set
+
+    /**
+     * Dimensions of the free indexes
+     * @return pointer to the first dimension
+     */
+    inline const Index* dimensions() const{
+        return rank_ > MAX_RANK ? large_shape_.get() : shape_;
+    }
+
+    /**
+     * Strides of the free indexes
+     * @return pointer to the first stride
+     */
+    inline const Index* strides() const{
+        return dimensions() + rank_;
+    }
+
+    /**
+     * Private Costructor
+     * @param data : first element of the view
+     * @param dimensions : dimensions of the free indexes
+     * @param strides : strides of the free indexes
+     * @param rank : number of free indexes
+     * @return a view on the elements starting from data
+     */
+    NKSlice(T* data, const Index dimensions[], const Index strides[], const int rank) :
+            data_(data),
+            rank_(rank)
+    {
+        Index* shape = shape_;
+        if(rank > MAX_RANK){
+            large_shape_ = shared_ptr<Index[]>(new Index[2 * rank]);
+            shape = large_shape_.get();
+        }
+        for(int i = 0; i < rank; ++i){
+            shape[i] = dimensions[i];
+            shape[rank + i] = strides[i];
+        }
+    }
+
+    /**
+     * It throws and exception if the element poitend to indexes does not exisit
+     * @param indexes : tupla of element
+     * @param dim : number of indexes
+     */
+    inline void checkExistence(const Index indexes[], const int dim) const{
+        if(dim != rank_)
+            throw invalid_argument("Indexes number not equal to rank");
+        const Index* dimensions_ = dimensions();
+        for(int i = 0; i < dim; ++i){
+            if(indexes[i] < 0 || indexes[i] >= dimensions_[i]){
+                throw out_of_range ("Indexes out of range");
+            }
+        }
+    }
+
+    /**
+     * Convert tupla into the offset of the element from the first one of the view
+     * @param tupla : element indexes
+     * @param dim : number of indexes
+     * @return offset of the element pointed by tupla
+     */
+    inline Index calculatePosition(const Index tupla[], const int dim) const {
+        const Index* strides_ = strides();
+        Index position = 0;
+        for(int i = 0; i < dim; ++i){
+            position += strides_[i] * tupla[i];
+        }
+        return position;
+    }
+
+public:
+    /**
+     * Read-only view on the same elements
+     * @return view that cannot update the elements
+     */
+    operator NKSlice<const T>() const{
+        return NKSlice<const T>(data_, dimensions(), strides(), rank_);
+    }
+
+    /**
+     * Rank of the view
+     * @return number of indexes not fixed by the slicing
+     */
+    inline int rank() const{
+        return rank_;
+    }
+
+    /**
+     * Slicing on the first free index
+     * @param val : value assigned to the index
+     * @return view with one more index fixed
+     */
+    inline NKSlice operator[](const Index val) const{
+        if(rank_ == 0 || val < 0 || val >= dimensions()[0]){
+            throw out_of_range ("Indexes out of range");
+        }
+        return NKSlice(data_ + val * strides()[0], dimensions() + 1, strides() + 1, rank_ - 1);
+    }
+
+    /**
+     * Get an element
+     * @param INDEXES : position to be read, one for each free index
+     * @return value pointed by INDEXES
+     */
+    template<typename ...Ints>
+    inline Element_ get(Ints... INDEXES) const{
+        const Index idxs[] = {INDEXES..., 0};
+        checkExistence(idxs, (int)sizeof...(INDEXES));
+        return data_[calculatePosition(idxs, (int)sizeof...(INDEXES))];
+    }
+
+    /**
+     * Get an element without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position to be read, one for each free index
+     * @return value pointed by INDEXES
+     */
+    template<typename ...Ints>
+    inline Element_ getUnchecked(Ints... INDEXES) const{
+        return (*this)(INDEXES...);
+    }
+
+    /**
+     * Access an element without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position of the element, one for each free index
+     * @return reference to the element, so that it can be updated in place
+     */
+    template<typename ...Ints>
+    inline T& operator()(Ints... INDEXES){
+        const Index idxs[] = {INDEXES..., 0};
+        if(CHECK_ACCESS)
+            checkExistence(idxs, (int)sizeof...(INDEXES));
+        return data_[calculatePosition(idxs, (int)sizeof...(INDEXES))];
+    }
+
+    /**
+     * Access an element of a const view without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position of the element, one for each free index
+     * @return const reference to the element
+     */
+    template<typename ...Ints>
+    inline const T& operator()(Ints... INDEXES) const{
+        const Index idxs[] = {INDEXES..., 0};
+        if(CHECK_ACCESS)
+            checkExistence(idxs, (int)sizeof...(INDEXES));
+        return data_[calculatePosition(idxs, (int)sizeof...(INDEXES))];
+    }
+
+    /**
+     * Access an element
+     * @param INDEXES : position of the element, one for each free index
+     * @return reference to the element, so that it can be updated in place
+     */
+    template<typename ...Ints>
+    inline T& at(Ints... INDEXES){
+        const Index idxs[] = {INDEXES..., 0};
+        checkExistence(idxs, (int)sizeof...(INDEXES));
+        return data_[calculatePosition(idxs, (int)sizeof...(INDEXES))];
+    }
+
+    /**
+     * Access an element of a const view
+     * @param INDEXES : position of the element, one for each free index
+     * @return const reference to the element
+     */
+    template<typename ...Ints>
+    inline const T& at(Ints... INDEXES) const{
+        const Index idxs[] = {INDEXES..., 0};
+        checkExistence(idxs, (int)sizeof...(INDEXES));
+        return data_[calculatePosition(idxs, (int)sizeof...(INDEXES))];
+    }
+
+    /**
+     * Set an element value, only on views of non-const tensors
+     * @param value : new value of the element
+     * @param INDEXES : tupla of element to be setted, one for each free index
+     */
+    template<typename ...Ints>
+    inline void set(const Element_& value, Ints... INDEXES){
+        const Index idxs[] = {INDEXES..., 0};
+        checkExistence(idxs, (int)sizeof...(INDEXES));
+        data_[calculatePosition(idxs, (int)sizeof...(INDEXES))] = value;
+    }
+
+    /**
+     * Set an element value without checking the indexes, unless CHECK_ACCESS is set
+     * @param value : new value of the element
+     * @param INDEXES : tupla of element to be setted, one for each free index
+     */
+    template<typename ...Ints>
+    inline void setUnchecked(const Element_& value, Ints... INDEXES){
+        const Index idxs[] = {INDEXES..., 0};
+        if(CHECK_ACCESS)
+            checkExistence(idxs, (int)sizeof...(INDEXES));
+        data_[calculatePosition(idxs, (int)sizeof...(INDEXES))] = value;
+    }
+
+    /**
+     * This method create a tensor duplicating the elements of the view, that can outlive the sliced tensor
+     * @return new tensor with the same dimensions and elements of the view
+     */
+    NKTensor<Element_> copy() const{
+        const Index* dimensions_ = dimensions();
+        NKTensor<Element_> new_tensor(vector<Index>(dimensions_, dimensions_ + rank_));
+        // a tensor of rank 0 has a single element and no iterators
+        if(rank_ == 0){
+            new_tensor.set(*data_);
+            return new_tensor;
+        }
+        vector<Index> idxs(rank_);
+        for(auto it = new_tensor.begin(); it != new_tensor.end(); ++it){
+            *it = data_[calculatePosition(idxs.data(), rank_)];
+            for(int i = rank_ - 1; i >= 0 && ++idxs[i] == dimensions_[i]; --i)
+                idxs[i] = 0;
+        }
+        return new_tensor;
+    }
+};
+
+#endif //TENSORLIBRARY_NKSLICE_H
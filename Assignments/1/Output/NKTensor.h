@@ -5,9 +5,13 @@
 #include <iostream>
 #include <tuple>
 #include <memory>
+#include <algorithm>
 #include "Utility.h"
 #include "NKIterator.h"
 #include "NKIteratorOneDim.h"
+#include "NKSlice.h"
+#include "StridedCopy.h"
+#include "StridedSpan.h"
 
 using namespace std;
 
@@ -21,13 +25,17 @@ template <class T>
 class NKTensor {
 private:
     int rank_;
-    vector<int> dimensions_;
-    vector<int> strides_;
-    shared_ptr<vector<T>> array_;
-    int start_pointer_;
-    int end_pointer_;
+    vector<Index> dimensions_;
+    vector<Index> strides_;
+    shared_ptr<Storage<T>> array_;
+    Index start_pointer_;
+    Index end_pointer_;
     friend class NKIterator<T>;
+    friend class NKIterator<const T>;
     friend class NKIteratorOneDim<T>;
+    friend class NKIteratorOneDim<const T>;
+    friend class NKSlice<T>;
+    friend class NKSlice<const T>;
     template <class T1, int R>
     friend class ROTensor;
     template <class T1, int...D>
@@ -37,7 +45,7 @@ private:
      * It throws and exception if the element poitend to indexes does not exisit
      * @param indexes : tupla of element
      */
-    inline void checkExistence(const vector<int>& indexes) const{
+    inline void checkExistence(const vector<Index>& indexes) const{
         if(indexes.size() != rank_)
             throw invalid_argument("Indexes number not equal to rank");
         for(int i = 0; i< rank_; ++i){
@@ -47,7 +55,7 @@ private:
         }
     }
 
-    inline void checkExistence(const int indexes[], const int dim) const{
+    inline void checkExistence(const Index indexes[], const int dim) const{
         if(dim != rank_)
             throw invalid_argument("Indexes number not equal to rank");
         for(int i = 0; i< dim; ++i){
@@ -62,7 +70,7 @@ private:
      * @param idx : index number
      * @param val : index value
      */
-    inline void checkIndex(const int idx, const int val) const{
+    inline void checkIndex(const int idx, const Index val) const{
         if(idx<0 || idx>=rank_ || val<0 || val>=dimensions_.at(idx)){
             throw out_of_range ("Indexes out of range");
         }
@@ -78,6 +86,51 @@ private:
         }
     }
 
+    /**
+     * Position of the first element along an index, the other indexes being fixed.
+     * It throws an exception if those elements do not exist
+     * @param idx : index to scan
+     * @param fixed_values : values of the other indexes
+     * @param dim : number of fixed values
+     * @return position in the array of the first element along idx
+     */
+    inline Index linePosition(const int idx, const Index fixed_values[], const int dim) const{
+        if(rank_ == 0)
+            throw invalid_argument("Unsupported operation on tensor with rank 0");
+        if(idx < 0 || idx >= rank_)
+            throw out_of_range("Index to scan doesn't exist.");
+        if(dim != rank_ - 1)
+            throw invalid_argument("Indexes number not equal to rank - 1.");
+        Index position = start_pointer_;
+        for(int i = 0; i < dim; ++i){
+            // fixed_values skips idx
+            const int j = i < idx ? i : i + 1;
+            if(fixed_values[i] < 0 || fixed_values[i] >= dimensions_[j]){
+                throw out_of_range("Indexes out of range");
+            }
+            position += strides_[j] * fixed_values[i];
+        }
+        return position;
+    }
+
+    /**
+     * Strides of a contiguous tensor, with the elements in row-major order
+     * It throws an exception if a dimension is not positive or if the number of elements does not fit in an Index
+     * @param dimensions : dimensions of the tensor
+     * @param strides : where the strides are written, one for each dimension
+     * @return number of elements of the tensor
+     */
+    static Index rowMajorStrides(const vector<Index>& dimensions, vector<Index>& strides){
+        Index element_number = 1;
+        for (int i = (int)dimensions.size() - 1; i >= 0 ; --i) {
+            if(dimensions.at(i) <= 0)
+                throw invalid_argument("Dimensions value must not be equal to 0!");
+            strides.at(i) = element_number;
+            element_number = checkedProduct(element_number, dimensions.at(i));
+        }
+        return element_number;
+    }
+
     /**
      * A private constructor used to create a precise new tensor (used for slicing)
      * @param array : pointer to the shared memory where datas are stored
@@ -88,36 +141,36 @@ private:
      * @return
      */
     NKTensor(
-            const shared_ptr<vector<T>>& array,
-            const vector<int>& dimensions,
-            const vector<int>& strides,
-            const int start_pointer,
-            const int end_pointer
+            const shared_ptr<Storage<T>>& array,
+            const vector<Index>& dimensions,
+            const vector<Index>& strides,
+            const Index start_pointer,
+            const Index end_pointer
     ) : rank_(dimensions.size()),
-        dimensions_(vector<int>(dimensions)),
-        strides_(vector<int>(strides)),
+        dimensions_(vector<Index>(dimensions)),
+        strides_(vector<Index>(strides)),
         array_ (array),
         start_pointer_(start_pointer),
         end_pointer_(end_pointer)
     {}
 
     /**
-     * Convert tupla into int to access the array
+     * Convert tupla into Index to access the array
      * @param tupla : element indexes
      * @return position index of the element pointed by tupla in the array
      */
-    inline int calculatePosition(const vector<int>& tupla) const {
-        int position = start_pointer_;
+    inline Index calculatePosition(const vector<Index>& tupla) const {
+        Index position = start_pointer_;
         for(int i = 0 ; i<rank_; ++i){
-            position += strides_.at(i)*tupla.at(i);
+            position += strides_[i]*tupla[i];
         }
         return position;
     }
 
-    inline int calculatePosition(const int tupla[], const int dim) const {
-        int position = start_pointer_;
+    inline Index calculatePosition(const Index tupla[], const int dim) const {
+        Index position = start_pointer_;
         for(int i = 0 ; i < dim; ++i){
-            position += strides_.at(i)*tupla[i];
+            position += strides_[i]*tupla[i];
         }
         return position;
     }
@@ -137,10 +190,10 @@ private:
         if (idx>=dimensions_.size()-1){
             throw out_of_range("Out of range exception! No possible operations.");
         }
-        vector<int> new_dimensions_(dimensions_);
+        vector<Index> new_dimensions_(dimensions_);
         new_dimensions_.at(idx+1) = new_dimensions_.at(idx) * new_dimensions_.at(idx+1);
         new_dimensions_.erase(new_dimensions_.begin()+idx);
-        vector<int> new_strides_(strides_);
+        vector<Index> new_strides_(strides_);
         new_strides_.erase(new_strides_.begin()+idx);
         NKTensor new_tensor(array_,new_dimensions_,new_strides_,start_pointer_,end_pointer_);
         return new_tensor;
@@ -151,7 +204,7 @@ public:
      * Default constructor
      * @return new tensor or rank 0 (like a variable)
      */
-    NKTensor() : NKTensor(vector<int>({})){}
+    NKTensor() : NKTensor(vector<Index>({})){}
 
     /**
      * Constructor with parameter pack
@@ -159,26 +212,28 @@ public:
      * @return new tensor with dimensions DIM
      */
     template<typename ...Ints>
-    NKTensor(Ints... DIM) :  NKTensor(vector<int>({DIM...})){}
+    NKTensor(Ints... DIM) :  NKTensor(vector<Index>({DIM...})){}
 
     /**
      * Constructor with vector
      * @param dimensions : vector of int corresponding to tensor dimensions
      * @return new tensor with dimensions dimensions
      */
-    NKTensor(const vector<int>& dimensions) :
+    NKTensor(const vector<int>& dimensions) : NKTensor(vector<Index>(dimensions.begin(), dimensions.end())){}
+
+    /**
+     * Constructor with vector
+     * @param dimensions : vector of Index corresponding to tensor dimensions
+     * @return new tensor with dimensions dimensions
+     * It throws an exception if the number of elements does not fit in an Index
+     */
+    NKTensor(const vector<Index>& dimensions) :
             rank_(dimensions.size()),
-            dimensions_(vector<int>(dimensions)),
-            strides_(vector<int>(rank_))
+            dimensions_(vector<Index>(dimensions)),
+            strides_(vector<Index>(rank_))
     {
-        int element_number = 1;
-        for (int i = rank_ - 1; i >= 0 ; --i) {
-            if(dimensions_.at(i) <= 0)
-                throw invalid_argument("Dimensions value must not be equal to 0!");
-            strides_.at(i) = element_number;
-            element_number *= dimensions_.at(i);
-        }
-        array_ = make_shared<vector<T>>(element_number);
+        const Index element_number = rowMajorStrides(dimensions_, strides_);
+        array_ = make_shared<Storage<T>>(element_number, T());
         start_pointer_= 0;
         if(rank_==0){
             end_pointer_=0;
@@ -221,31 +276,69 @@ public:
      */
     NKTensor& operator=(NKTensor&& ten) = default;
 
+    /**
+     * Sharing Constructor from a rank-only tensor
+     * @param ten : tensor whose elements are shared
+     * @return a tensor sharing the elements of ten, with the same dimensions and strides
+     */
+    template <int R>
+    NKTensor(const ROTensor<T, R>& ten) :
+            rank_(R),
+            dimensions_(ten.dimensions_, ten.dimensions_ + R),
+            strides_(ten.strides_, ten.strides_ + R),
+            array_(ten.array_),
+            start_pointer_(ten.start_pointer_),
+            end_pointer_(ten.end_pointer_)
+    {}
+
+    /**
+     * Sharing Constructor from a tensor with compile-time dimensions
+     * @param ten : tensor whose elements are shared, stored on the heap
+     * @return a tensor sharing the elements of ten, with the same dimensions
+     */
+    template <int... D>
+    NKTensor(const RDTensor<T, D...>& ten) :
+            rank_(sizeof...(D)),
+            dimensions_({D...}),
+            strides_(RDTensor<T, D...>::strides_.begin(), RDTensor<T, D...>::strides_.end())
+    {
+        static_assert(!RDTensor<T, D...>::INLINE, "Inline elements cannot be shared");
+        array_ = ten.array_;
+        start_pointer_ = ten.start_pointer_;
+        end_pointer_ = start_pointer_ + RDTensor<T, D...>::SIZE;
+    }
+
+    /**
+     * Sharing Assignment from a rank-only tensor
+     * @param ten : tensor whose elements are shared
+     * @return reference to the tensor
+     */
+    template <int R>
+    NKTensor& operator=(const ROTensor<T, R>& ten){
+        return *this = NKTensor(ten);
+    }
+
+    /**
+     * Sharing Assignment from a tensor with compile-time dimensions
+     * @param ten : tensor whose elements are shared
+     * @return reference to the tensor
+     */
+    template <int... D>
+    NKTensor& operator=(const RDTensor<T, D...>& ten){
+        return *this = NKTensor(ten);
+    }
+
     /**
      * This method create a tensor's copy duplicating the array, which contains only those fields concerning the array's portion used by the tensor
      * @return : A tensor's copy
      */
-    NKTensor copy(){
-        vector<int> new_strides_(rank_);
-        int element_number = 1;
-        for (int i = rank_ - 1; i >= 0 ; --i) {
-            new_strides_.at(i) = element_number;
-            element_number *= dimensions_.at(i);
-        }
-        shared_ptr<vector<T>> new_array = make_shared<vector<T>>(element_number);
-        if(rank_ != 0){
-            NKTensor copied_tensor_(new_array, dimensions_, new_strides_, 0, dimensions_.at(0)*new_strides_.at(0));
-            auto j = copied_tensor_.begin();
-            for(auto i = begin(); i < end(); ++i){
-                copied_tensor_.set(*i, j.currentPosition());
-                ++j;
-            }
-            return copied_tensor_;
-        } else{
-            NKTensor copied_tensor_(new_array, dimensions_, strides_, 0, 0);
-            copied_tensor_.set(get());
-            return copied_tensor_;
-        }
+    NKTensor copy() const{
+        vector<Index> new_strides_(rank_);
+        const Index element_number = rowMajorStrides(dimensions_, new_strides_);
+        shared_ptr<Storage<T>> new_array = make_shared<Storage<T>>(element_number);
+        stridedCopy(array_->data() + start_pointer_, dimensions_.data(), strides_.data(), rank_, new_array->data());
+        Index new_end_pointer_ = rank_ == 0 ? 0 : element_number;
+        return NKTensor(new_array, dimensions_, new_strides_, (Index)0, new_end_pointer_);
     }
 
     /**
@@ -255,7 +348,7 @@ public:
      */
     template<typename ...Ints>
     inline T get(Ints... INDEXES) const{
-        int idxs[] = {INDEXES...};
+        Index idxs[] = {INDEXES...};
         return getWithArray(idxs, (int)sizeof...(INDEXES));
     }
 
@@ -264,17 +357,9 @@ public:
      * @param indexes : position to be read
      * @return value pointed by indexes
      */
-    inline T getWithArray(const int indexes[], const int dim) const{
-        try{
-            checkExistence(indexes, dim);
-        }
-        catch(invalid_argument e){
-            throw e;
-        }
-        catch(out_of_range e){
-            throw e;
-        }
-        return array_->at(calculatePosition(indexes, dim));
+    inline T getWithArray(const Index indexes[], const int dim) const{
+        checkExistence(indexes, dim);
+        return (*array_)[calculatePosition(indexes, dim)];
     }
 
     /**
@@ -282,27 +367,69 @@ public:
      * @param indexes : position to be read
      * @return value pointed by indexes
      */
-    inline T get(const vector<int>& indexes) const{
-        try{
-            checkExistence(indexes);
-        }
-        catch(invalid_argument e){
-            throw e;
-        }
-        catch(out_of_range e){
-            throw e;
-        }
-        return array_->at(calculatePosition(indexes));
+    inline T get(const vector<Index>& indexes) const{
+        checkExistence(indexes);
+        return (*array_)[calculatePosition(indexes)];
     }
 
     /**
-     * Like get
+     * Get an element without checking the indexes, unless CHECK_ACCESS is set
      * @param INDEXES : position to be read
-     * @return value pointed by indexes
+     * @return value pointed by INDEXES
+     */
+    template<typename ...Ints>
+    inline T getUnchecked(Ints... INDEXES) const{
+        return (*this)(INDEXES...);
+    }
+
+    /**
+     * Access an element without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position of the element
+     * @return reference to the element, so that it can be updated in place, e.g. t(i, j) += x
+     */
+    template<typename ...Ints>
+    inline T& operator()(Ints... INDEXES){
+        const Index idxs[] = {INDEXES..., 0};
+        if(CHECK_ACCESS)
+            checkExistence(idxs, (int)sizeof...(INDEXES));
+        return (*array_)[calculatePosition(idxs, (int)sizeof...(INDEXES))];
+    }
+
+    /**
+     * Access an element of a const tensor without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position of the element
+     * @return reference to the element
+     */
+    template<typename ...Ints>
+    inline const T& operator()(Ints... INDEXES) const{
+        const Index idxs[] = {INDEXES..., 0};
+        if(CHECK_ACCESS)
+            checkExistence(idxs, (int)sizeof...(INDEXES));
+        return (*array_)[calculatePosition(idxs, (int)sizeof...(INDEXES))];
+    }
+
+    /**
+     * Access an element
+     * @param INDEXES : position of the element
+     * @return reference to the element, so that it can be updated in place
+     */
+    template<typename ...Ints>
+    inline T& at(Ints... INDEXES){
+        const Index idxs[] = {INDEXES..., 0};
+        checkExistence(idxs, (int)sizeof...(INDEXES));
+        return (*array_)[calculatePosition(idxs, (int)sizeof...(INDEXES))];
+    }
+
+    /**
+     * Access an element of a const tensor
+     * @param INDEXES : position of the element
+     * @return reference to the element
      */
     template<typename ...Ints>
-    inline T operator()(Ints... INDEXES){
-        return get(INDEXES...);
+    inline const T& at(Ints... INDEXES) const{
+        const Index idxs[] = {INDEXES..., 0};
+        checkExistence(idxs, (int)sizeof...(INDEXES));
+        return (*array_)[calculatePosition(idxs, (int)sizeof...(INDEXES))];
     }
 
     /**
@@ -312,8 +439,7 @@ public:
      */
     template<typename ...Ints>
     inline void set(const T& value, Ints... INDEXES){
-        int idxs[] = {INDEXES...};
-        //vector<int> idxs ={INDEXES...};
+        Index idxs[] = {INDEXES...};
         setWithArray(value, idxs, (int)sizeof...(INDEXES));
     }
 
@@ -322,17 +448,9 @@ public:
      * @param value : new value of the element
      * @param indexes : tupla of element to be setted
      */
-    inline void setWithArray(const T& value, const int indexes[], const int dim){
-        try{
-            checkExistence(indexes, dim);
-        }
-        catch(invalid_argument e){
-            throw e;
-        }
-        catch(out_of_range e){
-            throw e;
-        }
-        array_->at(calculatePosition(indexes, dim)) = value;
+    inline void setWithArray(const T& value, const Index indexes[], const int dim){
+        checkExistence(indexes, dim);
+        (*array_)[calculatePosition(indexes, dim)] = value;
     }
 
     /**
@@ -340,17 +458,22 @@ public:
      * @param value : new value of the element
      * @param indexes : tupla of element to be setted
      */
-    inline void set(const T& value, const vector<int>& indexes){
-        try{
-            checkExistence(indexes);
-        }
-        catch(invalid_argument e){
-            throw e;
-        }
-        catch(out_of_range e){
-            throw e;
-        }
-        array_->at(calculatePosition(indexes)) = value;
+    inline void set(const T& value, const vector<Index>& indexes){
+        checkExistence(indexes);
+        (*array_)[calculatePosition(indexes)] = value;
+    }
+
+    /**
+     * Set an element value without checking the indexes, unless CHECK_ACCESS is set
+     * @param value : new value of the element
+     * @param INDEXES : tupla of element to be setted
+     */
+    template<typename ...Ints>
+    inline void setUnchecked(const T& value, Ints... INDEXES){
+        const Index idxs[] = {INDEXES..., 0};
+        if(CHECK_ACCESS)
+            checkExistence(idxs, (int)sizeof...(INDEXES));
+        (*array_)[calculatePosition(idxs, (int)sizeof...(INDEXES))] = value;
     }
 
     /**
@@ -359,20 +482,20 @@ public:
      * @param val : is the value assigned to the index
      * @return new sliced tensor
      */
-    inline NKTensor slicing(const int idx, const int val){
+    inline NKTensor slicing(const int idx, const Index val){
         try{
             checkIndex(idx,val);
         }
         catch(out_of_range e){
             throw (e);
         }
-        vector<int> new_dimensions_(dimensions_);
+        vector<Index> new_dimensions_(dimensions_);
         new_dimensions_.erase(new_dimensions_.begin() + idx);
-        vector<int> new_strides_(strides_);
+        vector<Index> new_strides_(strides_);
         new_strides_.erase(new_strides_.begin() + idx);
-        shared_ptr<vector<T>> new_array_ = array_;
-        int new_start_pointer_ = start_pointer_ + val * strides_.at(idx);
-        int new_end_pointer_;
+        shared_ptr<Storage<T>> new_array_ = array_;
+        Index new_start_pointer_ = start_pointer_ + val * strides_.at(idx);
+        Index new_end_pointer_;
         if(new_dimensions_.size() == 0){
             new_end_pointer_ = new_start_pointer_;
         }
@@ -384,17 +507,32 @@ public:
     }
 
     /**
-     * Slicing
-     * @param val
-     * @return
+     * Slicing on the first index, without allocating the shape
+     * @param val : value assigned to the first index
+     * @return view on the sliced elements, that must not outlive them
      */
-    NKTensor operator[](const int val){
-        try{
-            return slicing(0, val);
-        }
-        catch (out_of_range e){
-            throw e;
-        }
+    NKSlice<T> operator[](const Index val) &{
+        checkIndex(0, val);
+        return NKSlice<T>(array_->data() + start_pointer_ + val * strides_[0], dimensions_.data() + 1, strides_.data() + 1, rank_ - 1);
+    }
+
+    /**
+     * Slicing on the first index, without allocating the shape
+     * @param val : value assigned to the first index
+     * @return read-only view on the sliced elements, that must not outlive them
+     */
+    NKSlice<const T> operator[](const Index val) const&{
+        checkIndex(0, val);
+        return NKSlice<const T>(array_->data() + start_pointer_ + val * strides_[0], dimensions_.data() + 1, strides_.data() + 1, rank_ - 1);
+    }
+
+    /**
+     * Slicing on the first index of a temporary tensor
+     * @param val : value assigned to the first index
+     * @return new sliced tensor, sharing the elements
+     */
+    NKTensor operator[](const Index val) &&{
+        return slicing(0, val);
     }
 
     /**
@@ -404,18 +542,37 @@ public:
      * As the tensor is sliced the remaining indexes number must be decrease of one because the slice rank decrease.
      * @return new sliced tensor
      */
-    inline NKTensor slicing(const vector<pair<int,int>>& idx_val){
-        vector<pair<int,int>> idx_val_tmp(idx_val);
-        NKTensor tmp(*this);
-        for(int i=0;i<idx_val_tmp.size();++i){
-            tmp = tmp.slicing(idx_val_tmp[i].first, idx_val_tmp[i].second);
-            for(int j = i + 1; j < idx_val_tmp.size(); ++j){
-                if(idx_val_tmp[j].first > idx_val_tmp[i].first){
-                    idx_val_tmp[j].first--;
+    inline NKTensor slicing(const vector<pair<int,Index>>& idx_val){
+        Index new_start_pointer_ = start_pointer_;
+        for(int i = 0; i < idx_val.size(); ++i){
+            checkIndex(idx_val[i].first, idx_val[i].second);
+            for(int j = 0; j < i; ++j){
+                if(idx_val[j].first == idx_val[i].first){
+                    throw invalid_argument("Index sliced twice. No possible operations.");
                 }
             }
+            new_start_pointer_ += idx_val[i].second * strides_[idx_val[i].first];
+        }
+        // the indexes left are collected in a single pass, building only the shape of the result
+        vector<Index> new_dimensions_;
+        vector<Index> new_strides_;
+        new_dimensions_.reserve(rank_ - idx_val.size());
+        new_strides_.reserve(rank_ - idx_val.size());
+        for(int i = 0; i < rank_; ++i){
+            bool sliced = false;
+            for(int j = 0; j < idx_val.size() && !sliced; ++j){
+                sliced = idx_val[j].first == i;
+            }
+            if(!sliced){
+                new_dimensions_.push_back(dimensions_[i]);
+                new_strides_.push_back(strides_[i]);
+            }
         }
-        return tmp;
+        Index new_end_pointer_ = new_start_pointer_;
+        if(new_dimensions_.size() != 0){
+            new_end_pointer_ += new_dimensions_[0] * new_strides_[0];
+        }
+        return NKTensor(array_, new_dimensions_, new_strides_, new_start_pointer_, new_end_pointer_);
     }
 
     /**
@@ -425,7 +582,7 @@ public:
      * @param max : max index value used for windowing
      * @return New windowed Tensor
      */
-    inline NKTensor windowing(const int idx, const int min, const int max){
+    inline NKTensor windowing(const int idx, const Index min, const Index max){
         try{
             checkIndex(idx,min);
             checkIndex(idx,max);
@@ -436,12 +593,12 @@ public:
         if(min>max){
             throw invalid_argument("Min value is greater than max value. No possible operations.");
         }
-        vector<int> new_dimensions_(dimensions_);
+        vector<Index> new_dimensions_(dimensions_);
         new_dimensions_.at(idx) = (max - min + 1);
-        vector<int> new_strides_(strides_);
-        shared_ptr<vector<T>> new_array_ = array_;
-        int new_start_pointer_ = start_pointer_ + strides_.at(idx) * min;
-        int new_end_pointer_ = new_start_pointer_ + strides_.at(0) * new_dimensions_.at(0);
+        vector<Index> new_strides_(strides_);
+        shared_ptr<Storage<T>> new_array_ = array_;
+        Index new_start_pointer_ = start_pointer_ + strides_.at(idx) * min;
+        Index new_end_pointer_ = new_start_pointer_ + strides_.at(0) * new_dimensions_.at(0);
         NKTensor new_tensor(new_array_,new_dimensions_,new_strides_,new_start_pointer_,new_end_pointer_);
         return new_tensor;
     }
@@ -453,12 +610,28 @@ public:
      * same because windowing doesn't decrease the rank.
      * @return New Tensor windowed multiple times
      */
-    inline NKTensor windowing(const vector<tuple<int,int,int>>& t){
-        NKTensor tmp (*this);
-        for(int i=0;i<t.size();++i){
-            tmp = tmp.windowing(std::get<0>(t[i]), std::get<1>(t[i]), std::get<2>(t[i]));
+    inline NKTensor windowing(const vector<tuple<int,Index,Index>>& t){
+        // windows on the same index compose, so each one is checked against the shape left by the previous ones
+        vector<Index> new_dimensions_(dimensions_);
+        Index new_start_pointer_ = start_pointer_;
+        for(int i = 0; i < t.size(); ++i){
+            const int idx = std::get<0>(t[i]);
+            const Index min = std::get<1>(t[i]);
+            const Index max = std::get<2>(t[i]);
+            if(idx < 0 || idx >= rank_ || min < 0 || min >= new_dimensions_[idx] || max < 0 || max >= new_dimensions_[idx]){
+                throw out_of_range ("Indexes out of range");
+            }
+            if(min > max){
+                throw invalid_argument("Min value is greater than max value. No possible operations.");
+            }
+            new_dimensions_[idx] = max - min + 1;
+            new_start_pointer_ += strides_[idx] * min;
         }
-        return tmp;
+        Index new_end_pointer_ = new_start_pointer_;
+        if(rank_ != 0){
+            new_end_pointer_ += strides_[0] * new_dimensions_[0];
+        }
+        return NKTensor(array_, new_dimensions_, strides_, new_start_pointer_, new_end_pointer_);
     }
 
     /**
@@ -492,6 +665,15 @@ public:
         return iter;
     }
 
+    /**
+     * Begin iterator of a const tensor
+     * @return read-only iterator to the begin point
+     */
+    NKIterator<const T> begin() const{
+        NKIterator<const T> iter(*this, true);
+        return iter;
+    }
+
     /**
      * End iterator
      * @return iterator to the end point
@@ -501,36 +683,49 @@ public:
         return iter;
     }
 
+    /**
+     * End iterator of a const tensor
+     * @return read-only iterator to the end point
+     */
+    NKIterator<const T> end() const{
+        NKIterator<const T> iter(*this, false);
+        return iter;
+    }
+
     /**
      * Begin iterator of the tensor on only one dimension
      * @param idx : dimension to iterate
      * @param fixed_values : fixed values of other dimensions
      * @return iterator on dimension idx
      */
-    NKIteratorOneDim<T> begin(const int idx, const vector<int>& fixed_values){
-        try{
-            return NKIteratorOneDim<T>(*this, true, idx, fixed_values);
-        }
-        catch (out_of_range e){
-            throw e;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
+    NKIteratorOneDim<T> begin(const int idx, const vector<Index>& fixed_values){
+        const Index position = linePosition(idx, fixed_values.data(), fixed_values.size());
+        return NKIteratorOneDim<T>(array_->data() + position, strides_[idx], 0);
     }
 
     template <typename... Ints>
     NKIteratorOneDim<T> begin(const int idx, Ints... fixed_values){
-        vector<int> fv = {fixed_values...};
-        try{
-            return begin(idx, fv);
-        }
-        catch (out_of_range e){
-            throw e;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
+        const Index fv[] = {fixed_values..., 0};
+        const Index position = linePosition(idx, fv, sizeof...(fixed_values));
+        return NKIteratorOneDim<T>(array_->data() + position, strides_[idx], 0);
+    }
+
+    /**
+     * Begin iterator of a const tensor on only one dimension
+     * @param idx : dimension to iterate
+     * @param fixed_values : fixed values of other dimensions
+     * @return read-only iterator on dimension idx
+     */
+    NKIteratorOneDim<const T> begin(const int idx, const vector<Index>& fixed_values) const{
+        const Index position = linePosition(idx, fixed_values.data(), fixed_values.size());
+        return NKIteratorOneDim<const T>(array_->data() + position, strides_[idx], 0);
+    }
+
+    template <typename... Ints>
+    NKIteratorOneDim<const T> begin(const int idx, Ints... fixed_values) const{
+        const Index fv[] = {fixed_values..., 0};
+        const Index position = linePosition(idx, fv, sizeof...(fixed_values));
+        return NKIteratorOneDim<const T>(array_->data() + position, strides_[idx], 0);
     }
 
     /**
@@ -539,30 +734,72 @@ public:
      * @param fixed_values : fixed values of other dimensions
      * @return iterator on dimension idx
      */
-    NKIteratorOneDim<T> end(const int idx, const vector<int>& fixed_values){
-        try{
-            return NKIteratorOneDim<T>(*this, false, idx, fixed_values);
-        }
-        catch (out_of_range e){
-            throw e;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
+    NKIteratorOneDim<T> end(const int idx, const vector<Index>& fixed_values){
+        NKIteratorOneDim<T> iter = begin(idx, fixed_values);
+        iter.pos_ = dimensions_[idx];
+        return iter;
     }
 
     template <typename... Ints>
     NKIteratorOneDim<T> end(const int idx, Ints... fixed_values){
-        vector<int> fv = {fixed_values...};
-        try{
-            return end(idx, fv);
-        }
-        catch (out_of_range e){
-            throw e;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
+        NKIteratorOneDim<T> iter = begin(idx, fixed_values...);
+        iter.pos_ = dimensions_[idx];
+        return iter;
+    }
+
+    /**
+     * End iterator of a const tensor on only one dimension
+     * @param idx : dimension to iterate
+     * @param fixed_values : fixed values of other dimensions
+     * @return read-only iterator on dimension idx
+     */
+    NKIteratorOneDim<const T> end(const int idx, const vector<Index>& fixed_values) const{
+        NKIteratorOneDim<const T> iter = begin(idx, fixed_values);
+        iter.pos_ = dimensions_[idx];
+        return iter;
+    }
+
+    template <typename... Ints>
+    NKIteratorOneDim<const T> end(const int idx, Ints... fixed_values) const{
+        NKIteratorOneDim<const T> iter = begin(idx, fixed_values...);
+        iter.pos_ = dimensions_[idx];
+        return iter;
+    }
+
+    /**
+     * Elements along one dimension, to be accessed by position as in a plain array
+     * @param idx : dimension to scan
+     * @param fixed_values : fixed values of other dimensions
+     * @return span over the elements along idx, that must not outlive them
+     */
+    StridedSpan<T> span(const int idx, const vector<Index>& fixed_values){
+        const Index position = linePosition(idx, fixed_values.data(), fixed_values.size());
+        return StridedSpan<T>(array_->data() + position, strides_[idx], dimensions_[idx]);
+    }
+
+    template <typename... Ints>
+    StridedSpan<T> span(const int idx, Ints... fixed_values){
+        const Index fv[] = {fixed_values..., 0};
+        const Index position = linePosition(idx, fv, sizeof...(fixed_values));
+        return StridedSpan<T>(array_->data() + position, strides_[idx], dimensions_[idx]);
+    }
+
+    /**
+     * Elements of a const tensor along one dimension, to be read by position as in a plain array
+     * @param idx : dimension to scan
+     * @param fixed_values : fixed values of other dimensions
+     * @return read-only span over the elements along idx, that must not outlive them
+     */
+    StridedSpan<const T> span(const int idx, const vector<Index>& fixed_values) const{
+        const Index position = linePosition(idx, fixed_values.data(), fixed_values.size());
+        return StridedSpan<const T>(array_->data() + position, strides_[idx], dimensions_[idx]);
+    }
+
+    template <typename... Ints>
+    StridedSpan<const T> span(const int idx, Ints... fixed_values) const{
+        const Index fv[] = {fixed_values..., 0};
+        const Index position = linePosition(idx, fv, sizeof...(fixed_values));
+        return StridedSpan<const T>(array_->data() + position, strides_[idx], dimensions_[idx]);
     }
 
     /**
@@ -0,0 +1,419 @@
+#ifndef TENSORLIBRARY_RDTENSOR_H
+#define TENSORLIBRARY_RDTENSOR_H
+
+#include <vector>
+#include <array>
+#include <iostream>
+#include <tuple>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include "Utility.h"
+#include "NKTensor.h"
+#include "ROTensor.h"
+
+using namespace std;
+
+/**
+ * Row-major strides of a tensor with dimensions D
+ * @return strides, computed at compile time
+ */
+template <int... D>
+constexpr array<Index, sizeof...(D)> rowMajorStrides(){
+    array<Index, sizeof...(D)> dimensions = {D...};
+    array<Index, sizeof...(D)> strides = {};
+    Index element_number = 1;
+    for (int i = (int)sizeof...(D) - 1; i >= 0 ; --i) {
+        strides[i] = element_number;
+        element_number *= dimensions[i];
+    }
+    return strides;
+}
+
+/*Tensor whose whole shape is known at compile time: dimensions and strides are constexpr, so accessing an element
+with constant indexes is a load at a constant offset from the first element.
+Elements are stored in row-major order without gaps. Tensors of at most INLINE_BYTES bytes keep them inline, without
+any heap allocation, and are values: their copies hold copies of the elements, as for std::array. The elements of
+larger tensors, and of tensors built from the other tensor types, are on the heap and shared by the copies as for the
+other tensors*/
+template <class T, int... D>
+class RDTensor {
+public:
+    static constexpr int R = sizeof...(D);
+    static constexpr Index SIZE = ((Index)D * ... * 1);
+    static constexpr int INLINE_BYTES = 64;
+    static constexpr bool INLINE = SIZE * sizeof(T) <= INLINE_BYTES;
+
+private:
+    static_assert(R > 0, "Unsupported tensor with rank 0");
+    static_assert(((D > 0) && ...), "Dimensions value must not be equal to 0!");
+
+    static constexpr array<Index, R> dimensions_ = {D...};
+    static constexpr array<Index, R> strides_ = rowMajorStrides<D...>();
+
+    // null while the elements are inline
+    shared_ptr<Storage<T>> array_;
+    Index start_pointer_;
+    // first element, either in inline_ or in array_
+    T* data_;
+    array<T, INLINE ? SIZE : 0> inline_;
+    // sharing conversions to the other tensor types
+    friend class NKTensor<T>;
+    template <class T1, int R1>
+    friend class ROTensor;
+
+    /**
+     * It throws an exception if tensor with given dimensions and strides cannot be seen as this tensor type
+     * @param dimensions : dimensions of the tensor
+     * @param strides : strides of the tensor
+     * @param rank : rank of the tensor
+     */
+    static void checkShape(const Index dimensions[], const Index strides[], const int rank){
+        if(rank != R)
+            throw invalid_argument("Rank not equal to " + to_string(R));
+        for(int i = 0; i < R; ++i){
+            if(dimensions[i] != dimensions_[i])
+                throw invalid_argument("Dimensions not compatible. No possible operations.");
+            if(dimensions[i] > 1 && strides[i] != strides_[i])
+                throw invalid_argument("Elements not contiguous. No possible operations.");
+        }
+    }
+
+    /**
+     * Convert indexes into Index to access the elements, unrolled at compile time over R
+     * @param INDEXES : element indexes, one for each dimension
+     * @return position index of the element pointed by INDEXES from the first element
+     */
+    template<size_t... I, typename ...Ints>
+    static constexpr Index calculatePosition(index_sequence<I...>, Ints... INDEXES) {
+        return (0 + ... + (strides_[I] * INDEXES));
+    }
+
+    /**
+     * It throws and exception if the element poitend to INDEXES does not exisit
+     * @param INDEXES : element indexes, one for each dimension
+     */
+    template<size_t... I, typename ...Ints>
+    static void checkExistence(index_sequence<I...>, Ints... INDEXES) {
+        if(((INDEXES < 0 || INDEXES >= dimensions_[I]) || ...))
+            throw out_of_range ("Indexes out of range");
+    }
+
+public:
+    /**
+     * Default constructor
+     * @return new tensor with value-initialized elements
+     */
+    RDTensor() : start_pointer_(0), inline_() {
+        if(INLINE){
+            data_ = inline_.data();
+        }
+        else{
+            array_ = make_shared<Storage<T>>(SIZE, T());
+            data_ = array_->data();
+        }
+    }
+
+    /**
+     * Sharing constructor from a rank-only tensor
+     * @param ten : tensor with dimensions D and contiguous elements
+     * @return a tensor sharing the elements of ten
+     */
+    RDTensor(const ROTensor<T, R>& ten) : array_(ten.array_), start_pointer_(ten.start_pointer_) {
+        checkShape(ten.dimensions_, ten.strides_, R);
+        data_ = array_->data() + start_pointer_;
+    }
+
+    /**
+     * Sharing constructor from a tensor of rank known at runtime
+     * @param ten : tensor with dimensions D and contiguous elements
+     * @return a tensor sharing the elements of ten
+     */
+    RDTensor(const NKTensor<T>& ten) : array_(ten.array_), start_pointer_(ten.start_pointer_) {
+        checkShape(ten.dimensions_.data(), ten.strides_.data(), ten.rank_);
+        data_ = array_->data() + start_pointer_;
+    }
+
+    /**
+     * Copy Constructor
+     * @param ten : tensor to be copied
+     * @return a copy of ten, with copies of inline elements and sharing heap ones
+     */
+    RDTensor(const RDTensor& ten) : array_(ten.array_), start_pointer_(ten.start_pointer_), inline_(ten.inline_) {
+        data_ = array_ == nullptr ? inline_.data() : ten.data_;
+    }
+
+    /**
+     * Move Constructor
+     * @param ten : must not be const because it will be changed
+     * @return
+     */
+    RDTensor(RDTensor&& ten) : array_(std::move(ten.array_)), start_pointer_(ten.start_pointer_), inline_(ten.inline_) {
+        data_ = array_ == nullptr ? inline_.data() : ten.data_;
+    }
+
+    /**
+     * Destructor
+     */
+    ~RDTensor() = default;
+
+    /**
+     * Copy Assignment
+     * @param ten : tensor to be copied
+     * @return reference to the tensor, with copies of inline elements and sharing heap ones
+     */
+    RDTensor& operator=(const RDTensor& ten){
+        array_ = ten.array_;
+        start_pointer_ = ten.start_pointer_;
+        inline_ = ten.inline_;
+        data_ = array_ == nullptr ? inline_.data() : ten.data_;
+        return *this;
+    }
+
+    /**
+     * Move Assignment
+     * @param ten
+     * @return
+     */
+    RDTensor& operator=(RDTensor&& ten){
+        array_ = std::move(ten.array_);
+        start_pointer_ = ten.start_pointer_;
+        inline_ = ten.inline_;
+        data_ = array_ == nullptr ? inline_.data() : ten.data_;
+        return *this;
+    }
+
+    /**
+     * Sharing Assignment from a rank-only tensor
+     * @param ten : tensor with dimensions D and contiguous elements
+     * @return reference to the tensor
+     */
+    RDTensor& operator=(const ROTensor<T, R>& ten){
+        return *this = RDTensor(ten);
+    }
+
+    /**
+     * Sharing Assignment from a tensor of rank known at runtime
+     * @param ten : tensor with dimensions D and contiguous elements
+     * @return reference to the tensor
+     */
+    RDTensor& operator=(const NKTensor<T>& ten){
+        return *this = RDTensor(ten);
+    }
+
+    /**
+     * This method create a tensor's copy duplicating the elements
+     * @return : A tensor's copy
+     */
+    RDTensor copy() const{
+        RDTensor copied_tensor_;
+        std::copy(data_, data_ + SIZE, copied_tensor_.data_);
+        return copied_tensor_;
+    }
+
+    /**
+     * Get an element
+     * @param INDEXES : position to be read
+     * @return value pointed by INDEXES
+     */
+    template<typename ...Ints>
+    inline T get(Ints... INDEXES) const{
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        checkExistence(make_index_sequence<R>(), INDEXES...);
+        return data_[calculatePosition(make_index_sequence<R>(), INDEXES...)];
+    }
+
+    /**
+     * Get an element whose indexes are known at compile time, and so checked at compile time
+     * @param I : position to be read
+     * @return value pointed by I
+     */
+    template<int... I>
+    inline T get() const{
+        static_assert(sizeof...(I) == R, "Indexes number not equal to rank");
+        static_assert(((I >= 0 && I < D) && ...), "Indexes out of range");
+        constexpr Index position = calculatePosition(make_index_sequence<R>(), I...);
+        return data_[position];
+    }
+
+    /**
+     * Get an element without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position to be read
+     * @return value pointed by INDEXES
+     */
+    template<typename ...Ints>
+    inline T getUnchecked(Ints... INDEXES) const{
+        return (*this)(INDEXES...);
+    }
+
+    /**
+     * Access an element without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position of the element
+     * @return reference to the element, so that it can be updated in place, e.g. t(i, j) += x
+     */
+    template<typename ...Ints>
+    inline T& operator()(Ints... INDEXES){
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        if(CHECK_ACCESS)
+            checkExistence(make_index_sequence<R>(), INDEXES...);
+        return data_[calculatePosition(make_index_sequence<R>(), INDEXES...)];
+    }
+
+    /**
+     * Access an element of a const tensor without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position of the element
+     * @return reference to the element
+     */
+    template<typename ...Ints>
+    inline const T& operator()(Ints... INDEXES) const{
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        if(CHECK_ACCESS)
+            checkExistence(make_index_sequence<R>(), INDEXES...);
+        return data_[calculatePosition(make_index_sequence<R>(), INDEXES...)];
+    }
+
+    /**
+     * Access an element
+     * @param INDEXES : position of the element
+     * @return reference to the element, so that it can be updated in place
+     */
+    template<typename ...Ints>
+    inline T& at(Ints... INDEXES){
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        checkExistence(make_index_sequence<R>(), INDEXES...);
+        return data_[calculatePosition(make_index_sequence<R>(), INDEXES...)];
+    }
+
+    /**
+     * Access an element of a const tensor
+     * @param INDEXES : position of the element
+     * @return reference to the element
+     */
+    template<typename ...Ints>
+    inline const T& at(Ints... INDEXES) const{
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        checkExistence(make_index_sequence<R>(), INDEXES...);
+        return data_[calculatePosition(make_index_sequence<R>(), INDEXES...)];
+    }
+
+    /**
+     * Set an element value
+     * @param value : new value of the element
+     * @param INDEXES : tupla of element to be setted
+     */
+    template<typename ...Ints>
+    inline void set(const T& value, Ints... INDEXES){
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        checkExistence(make_index_sequence<R>(), INDEXES...);
+        data_[calculatePosition(make_index_sequence<R>(), INDEXES...)] = value;
+    }
+
+    /**
+     * Set an element whose indexes are known at compile time, and so checked at compile time
+     * @param value : new value of the element
+     * @param I : tupla of element to be setted
+     */
+    template<int... I>
+    inline void set(const T& value){
+        static_assert(sizeof...(I) == R, "Indexes number not equal to rank");
+        static_assert(((I >= 0 && I < D) && ...), "Indexes out of range");
+        constexpr Index position = calculatePosition(make_index_sequence<R>(), I...);
+        data_[position] = value;
+    }
+
+    /**
+     * Set an element value without checking the indexes, unless CHECK_ACCESS is set
+     * @param value : new value of the element
+     * @param INDEXES : tupla of element to be setted
+     */
+    template<typename ...Ints>
+    inline void setUnchecked(const T& value, Ints... INDEXES){
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        if(CHECK_ACCESS)
+            checkExistence(make_index_sequence<R>(), INDEXES...);
+        data_[calculatePosition(make_index_sequence<R>(), INDEXES...)] = value;
+    }
+
+    /**
+     * Dimension of an index
+     * @param idx : index number
+     * @return dimension of the index idx
+     */
+    static constexpr Index dimension(const int idx){
+        return dimensions_[idx];
+    }
+
+    /**
+     * Elements are contiguous, so iterators are plain pointers
+     */
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    /**
+     * Begin iterator
+     * @return iterator to the begin point
+     */
+    iterator begin(){
+        return data_;
+    }
+
+    /**
+     * Begin iterator of a const tensor
+     * @return read-only iterator to the begin point
+     */
+    const_iterator begin() const{
+        return data_;
+    }
+
+    /**
+     * End iterator
+     * @return iterator to the end point
+     */
+    iterator end(){
+        return data_ + SIZE;
+    }
+
+    /**
+     * End iterator of a const tensor
+     * @return read-only iterator to the end point
+     */
+    const_iterator end() const{
+        return data_ + SIZE;
+    }
+
+    /**
+     * Simply print some information on the tensor, just to help debugging
+     * @param name : name to be showed
+     */
+    void printTensor(const string name = "Tensor") const{
+        cout << endl;
+        cout << "Name: " << name << endl;
+        cout << "Rank: " << R << endl;
+        vector<Index> dimensions(dimensions_.begin(), dimensions_.end());
+        vector<Index> strides(strides_.begin(), strides_.end());
+        cout << "Dimensions: ";
+        showVector(dimensions);
+        cout << endl;
+        cout << "Strides: ";
+        showVector(strides);
+        cout << endl;
+        cout << "Array pointer: ";
+        if(array_ == nullptr)
+            cout << "inline";
+        else
+            cout << array_;
+        cout << endl;
+        cout << "Start pointer: " << start_pointer_ << endl;
+        cout << "Elements: {";
+        for(auto i = begin(); i < end(); ++i){
+            cout << *i;
+            if(i + 1 != end()){
+                cout << ", ";
+            }
+        }
+        cout << "}" << endl;
+        cout << endl;
+    }
+};
+
+#endif //TENSORLIBRARY_RDTENSOR_H
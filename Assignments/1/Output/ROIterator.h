@@ -5,6 +5,8 @@
 #include <iostream>
 #include <tuple>
 #include <memory>
+#include <iterator>
+#include <type_traits>
 #include "Utility.h"
 
 using namespace std;
@@ -12,12 +14,21 @@ using namespace std;
 template <class T, int R>
 class ROTensor;
 
+/**
+ * Iterator over all the elements of a tensor, in right-major order.
+ * ROIterator<T, R> writes the elements, ROIterator<const T, R> only reads them and is
+ * the one returned by begin() and end() on const tensors
+ */
 template<class T, int R>
 class ROIterator {
 private:
-    friend class ROTensor<T, R>;
-    const ROTensor<T, R>* tensor_; // reference to the tensor_ that has  to be iterated
-    int cur_ref_[R]; // tupla of the next element to be read
+    typedef typename remove_const<T>::type Element_;
+    friend class ROTensor<Element_, R>;
+    friend class ROIterator<const Element_, R>;
+    const ROTensor<Element_, R>* tensor_; // reference to the tensor_ that has  to be iterated
+    Index cur_ref_[R]; // tupla of the next element to be read
+    T* ptr_; // element pointed by cur_ref_, moved along with it by strides
+    ptrdiff_t pos_; // position of the element in the iteration order
 
     /**
      * Private Costructor
@@ -26,15 +37,50 @@ private:
      * @param start : true for begin iterator, false otherwise
      * @return the begin iterator on tensor_ if start = true, the end iterator otherwise
      */
-    ROIterator(const ROTensor<T, R>& ten, const bool start) : tensor_(&ten){
+    ROIterator(const ROTensor<Element_, R>& ten, const bool start) : tensor_(&ten){
         for(int i = 0; i < R; ++i)
             cur_ref_[i] = 0;
+        ptr_ = ten.array_->data() + ten.start_pointer_;
+        pos_ = 0;
         if(!start){
             cur_ref_[0] = ten.dimensions_[0];
+            ptr_ += ten.strides_[0] * ten.dimensions_[0];
+            pos_ = 1;
+            for(int i = 0; i < R; ++i)
+                pos_ *= ten.dimensions_[i];
         }
     }
 
+    /**
+     * Recompute tupla and pointer from the position in the iteration order, for random access
+     */
+    void seek(){
+        difference_type rest = pos_;
+        ptr_ = tensor_->array_->data() + tensor_->start_pointer_;
+        for(int i = R - 1; i > 0; --i){
+            cur_ref_[i] = rest % tensor_->dimensions_[i];
+            rest /= tensor_->dimensions_[i];
+            ptr_ += tensor_->strides_[i] * cur_ref_[i];
+        }
+        // the first index is not wrapped around, as in operator++
+        cur_ref_[0] = rest;
+        ptr_ += tensor_->strides_[0] * rest;
+    }
+
 public:
+    // random access iterator traits, so that standard algorithms can run over tensors
+    typedef random_access_iterator_tag iterator_category;
+    typedef Element_ value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    /**
+     * Default constructor
+     * @return singular iterator, to be assigned before use
+     */
+    ROIterator() : tensor_(nullptr), ptr_(nullptr), pos_(0) {}
+
     /**
      * It only shows the current tupla
      */
@@ -46,7 +92,7 @@ public:
      * For copy of a tensor
      * @return pointer to the internal tupla
      */
-    int* currentPosition(){
+    Index* currentPosition(){
         return cur_ref_;
     }
 
@@ -64,6 +110,17 @@ public:
      */
     ROIterator(ROIterator&& ite) = default;
 
+    /**
+     * Conversion to a read-only iterator
+     * @param ite : writing iterator to be converted
+     * @return read-only iterator on the same element
+     */
+    template<class U, class = typename enable_if<is_same<const U, T>::value && !is_same<U, T>::value>::type>
+    ROIterator(const ROIterator<U, R>& ite) : tensor_(ite.tensor_), ptr_(ite.ptr_), pos_(ite.pos_) {
+        for(int i = 0; i < R; ++i)
+            cur_ref_[i] = ite.cur_ref_[i];
+    }
+
     /**
      * Destructor
      */
@@ -88,32 +145,94 @@ public:
      * @return reference to the updated iterator
      */
     ROIterator& operator++ (){
-        int max_dim = cur_ref_[0];
-        bool updated = false;
         int i = R - 1;
-        while(!updated && i >= 0 ){
-            if(cur_ref_[i] == tensor_->dimensions_[i]-1){
-                cur_ref_[i]=0;
-                --i;
-            }
-            else{
-                ++cur_ref_[i];
-                updated = true;
-            }
-        }
-        if(!updated){
-            cur_ref_[0] = max_dim + 1;
+        while(i > 0 && cur_ref_[i] == tensor_->dimensions_[i]-1){
+            cur_ref_[i] = 0;
+            ptr_ -= tensor_->strides_[i] * (tensor_->dimensions_[i]-1);
+            --i;
         }
+        // the first index is not wrapped around, so that the last element is followed by the end iterator
+        ++cur_ref_[i];
+        ptr_ += tensor_->strides_[i];
+        ++pos_;
         return *this;
     }
 
     /**
      * Postfix ++ operator
      * @param n : imposed to 1
-     * @return
+     * @return copy of the iterator before the increment
      */
     ROIterator operator++(const int n){
-        return ++(*this);
+        ROIterator old(*this);
+        ++(*this);
+        return old;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to the updated iterator
+     */
+    ROIterator& operator-- (){
+        int i = R - 1;
+        while(i > 0 && cur_ref_[i] == 0){
+            cur_ref_[i] = tensor_->dimensions_[i]-1;
+            ptr_ += tensor_->strides_[i] * (tensor_->dimensions_[i]-1);
+            --i;
+        }
+        --cur_ref_[i];
+        ptr_ -= tensor_->strides_[i];
+        --pos_;
+        return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @param n : imposed to 1
+     * @return copy of the iterator before the decrement
+     */
+    ROIterator operator--(const int n){
+        ROIterator old(*this);
+        --(*this);
+        return old;
+    }
+
+    /**
+     * Random access
+     * @param n : number of elements to be skipped, also negative
+     * @return reference to the updated iterator
+     */
+    ROIterator& operator+= (const difference_type n){
+        pos_ += n;
+        seek();
+        return *this;
+    }
+
+    ROIterator& operator-= (const difference_type n){
+        return *this += -n;
+    }
+
+    ROIterator operator+ (const difference_type n) const{
+        ROIterator result(*this);
+        return result += n;
+    }
+
+    friend ROIterator operator+ (const difference_type n, const ROIterator& ite){
+        return ite + n;
+    }
+
+    ROIterator operator- (const difference_type n) const{
+        ROIterator result(*this);
+        return result -= n;
+    }
+
+    /**
+     * Distance between iterators on the same tensor
+     * @param ite : iterator to be subtracted from this
+     * @return number of elements from ite to this
+     */
+    difference_type operator- (const ROIterator& ite) const{
+        return pos_ - ite.pos_;
     }
 
     /**
@@ -121,8 +240,8 @@ public:
      * @param ite : iterator to be compared with this
      * @return true if they point to the same element in tensor_
      */
-    bool operator== (const ROIterator& ite){
-        return tensor_->calculatePosition(cur_ref_, R) == tensor_->calculatePosition(ite.cur_ref_, R);
+    bool operator== (const ROIterator& ite) const{
+        return ptr_ == ite.ptr_;
     }
 
     /**
@@ -130,27 +249,52 @@ public:
      * @param ite : iterator to be compared with this
      * @return true if they don't point to the same element in tensor_
      */
-    bool operator!= (const ROIterator& ite){
-        return tensor_->calculatePosition(cur_ref_, R) != tensor_->calculatePosition(ite.cur_ref_, R);
+    bool operator!= (const ROIterator& ite) const{
+        return ptr_ != ite.ptr_;
+    }
+
+    /**
+     * Ordering comparisons, by position in the iteration order
+     * @param ite : iterator to be compared with this
+     * @return
+     */
+    bool operator< (const ROIterator& ite) const{
+        return pos_ < ite.pos_;
+    }
+
+    bool operator> (const ROIterator& ite) const{
+        return pos_ > ite.pos_;
+    }
+
+    bool operator<= (const ROIterator& ite) const{
+        return pos_ <= ite.pos_;
+    }
+
+    bool operator>= (const ROIterator& ite) const{
+        return pos_ >= ite.pos_;
     }
 
     /**
      * Dereference operator
-     * @return the value of type T pointed
+     * @return reference to the element pointed, that can be written through a writing iterator
      */
-    T operator* () {
-        try{
-            T value = tensor_->getWithArray(cur_ref_, R);
-            return value;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
-        catch (out_of_range e){
-            throw e;
-        }
+    T& operator* () const{
+        return *ptr_;
+    }
+
+    T* operator-> () const{
+        return ptr_;
+    }
+
+    /**
+     * Subscript operator
+     * @param n : distance from the current element
+     * @return reference to the element n positions after the current one
+     */
+    T& operator[] (const difference_type n) const{
+        return *(*this + n);
     }
-    
+
 };
 
 
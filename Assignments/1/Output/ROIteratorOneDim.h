@@ -5,6 +5,7 @@
 #include <iostream>
 #include <tuple>
 #include <memory>
+#include <iterator>
 #include "Utility.h"
 
 using namespace std;
@@ -12,83 +13,43 @@ using namespace std;
 template <class T, int R>
 class ROTensor;
 
+/*Iterator along one index of a tensor, the other indexes being fixed. Elements along an index are a fixed stride apart
+in memory, so the iterator is the first element of the line and a position along it, with random access in O(1).
+Keeping the position, rather than a pointer moved by the stride, lets the end iterator stand one element past the line
+without forming a pointer outside the array.
+ROIteratorOneDim<const T> only reads the elements and is the one returned by begin(idx, ...) and end(idx, ...) on const tensors*/
 template <class T, int R>
 class ROIteratorOneDim {
 private:
-    friend class ROTensor<T, R>;
-    const ROTensor<T, R>* tensor_; // reference to the tensor_ that has  to be iterated
-    int cur_ref_[R]; // tupla of the next element to be read
-    int idx_to_scan_;
-
-    /**
-     * Check value for begin Iterator on only one dimension
-     * @param idx dimension to iterate
-     * @param fixed_values : fixed values of other dimensionsl,,
-     * @return
-     */
-    void checkOnDimIterator(const int idx, const int fixed_values[], const int dim){
-        if(idx < 0 || idx >= R)
-            throw out_of_range("Index to scan doesn't exist.");
-        if(dim != R - 1)
-            throw invalid_argument("Indexes number not equal to rank - 1.");
-        for(int i = 0; i< R; ++i) {
-            if(i != idx){
-                if(i < idx) {
-                    if (fixed_values[i] < 0 || fixed_values[i] >= tensor_->dimensions_[i]) {
-                        throw out_of_range("Indexes out of range");
-                    }
-                    cur_ref_[i] = fixed_values[i];
-                }
-                else {
-                    if (fixed_values[i - 1] < 0 || fixed_values[i - 1] >= tensor_->dimensions_[i]) {
-                        throw out_of_range("Indexes out of range");
-                    }
-                    cur_ref_[i] = fixed_values[i - 1];
-                }
-            }
-        }
-        cur_ref_[idx] = 0;
-    }
+    typedef typename remove_const<T>::type Element_;
+    friend class ROTensor<Element_, R>;
+    friend class ROIteratorOneDim<const Element_, R>;
+    T* base_; // first element of the line
+    Index stride_; // distance between two elements along the scanned index
+    Index pos_; // position of the element pointed along the line
 
     /**
      * Private Costructor
-     * @param ten : tensor_ to be iterated
-     * @param start : true for begin iterator, false otherwise
-     * @return the begin iterator on tensor_ if start = true, the end iterator otherwise
-     */
-    ROIteratorOneDim(const ROTensor<T, R>& ten, const bool start, const int idx, const int fixed_values[], const int dim) :
-            tensor_(&ten),
-            idx_to_scan_(idx)
-    {
-        try{
-            checkOnDimIterator(idx, fixed_values, dim);
-            if(!start){
-                cur_ref_[idx] = ten.dimensions_[idx];
-            }
-        }
-        catch (out_of_range e){
-            throw out_of_range("Index out of range. No possible operations.");
-        }
-        catch (invalid_argument e){
-            throw invalid_argument("Invalid argument. No possible operations.");
-        }
-    }
+     * @param base : first element of the line
+     * @param stride : stride of the scanned index
+     * @param pos : position of the element to be pointed
+     * @return iterator on the element pos along the line
+     */
+    ROIteratorOneDim(T* base, const Index stride, const Index pos) : base_(base), stride_(stride), pos_(pos) {}
 
 public:
-    /**
-     * It only shows the current tupla
-     */
-    void show(){
-        showVector(cur_ref_, R);
-    }
+    // random access iterator traits, so that standard algorithms can run along an index
+    typedef random_access_iterator_tag iterator_category;
+    typedef Element_ value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
 
     /**
-     * For copy of a tensor
-     * @return pointer to the internal tupla
+     * Default constructor
+     * @return singular iterator, to be assigned before use
      */
-    int* currentPosition(){
-        return cur_ref_;
-    }
+    ROIteratorOneDim() : base_(nullptr), stride_(1), pos_(0) {}
 
     /**
      * Copy constructor
@@ -104,6 +65,14 @@ public:
      */
     ROIteratorOneDim(ROIteratorOneDim&& ite) = default;
 
+    /**
+     * Conversion to a read-only iterator
+     * @param ite : writing iterator to be converted
+     * @return read-only iterator on the same element
+     */
+    template<class U, class = typename enable_if<is_same<const U, T>::value && !is_same<U, T>::value>::type>
+    ROIteratorOneDim(const ROIteratorOneDim<U, R>& ite) : base_(ite.base_), stride_(ite.stride_), pos_(ite.pos_) {}
+
     /**
      * Destructor
      */
@@ -128,43 +97,135 @@ public:
      * @return reference to the updated iterator
      */
     ROIteratorOneDim& operator++ (){
-        cur_ref_[idx_to_scan_]++;
+        ++pos_;
         return *this;
     }
 
     /**
      * Postfix ++ operator
      * @param n : imposed to 1
-     * @return
+     * @return copy of the iterator before the increment
      */
     ROIteratorOneDim operator++(const int n){
-        return ++(*this);
+        ROIteratorOneDim old(*this);
+        ++pos_;
+        return old;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to the updated iterator
+     */
+    ROIteratorOneDim& operator-- (){
+        --pos_;
+        return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @param n : imposed to 1
+     * @return copy of the iterator before the decrement
+     */
+    ROIteratorOneDim operator--(const int n){
+        ROIteratorOneDim old(*this);
+        --pos_;
+        return old;
+    }
+
+    /**
+     * Random access
+     * @param n : number of elements to be skipped, also negative
+     * @return reference to the updated iterator
+     */
+    ROIteratorOneDim& operator+= (const difference_type n){
+        pos_ += n;
+        return *this;
+    }
+
+    ROIteratorOneDim& operator-= (const difference_type n){
+        pos_ -= n;
+        return *this;
+    }
+
+    ROIteratorOneDim operator+ (const difference_type n) const{
+        return ROIteratorOneDim(base_, stride_, pos_ + n);
+    }
+
+    friend ROIteratorOneDim operator+ (const difference_type n, const ROIteratorOneDim& ite){
+        return ite + n;
+    }
+
+    ROIteratorOneDim operator- (const difference_type n) const{
+        return ROIteratorOneDim(base_, stride_, pos_ - n);
+    }
+
+    /**
+     * Distance between iterators along the same index
+     * @param ite : iterator to be subtracted from this
+     * @return number of elements from ite to this
+     */
+    difference_type operator- (const ROIteratorOneDim& ite) const{
+        return pos_ - ite.pos_;
     }
 
     /**
      * Equality comparison
      * @param ite : iterator to be compared with this
-     * @return true if they point to the same element in tensor_
+     * @return true if they point to the same element
      */
-    bool operator== (const ROIteratorOneDim& ite){
-        return tensor_->calculatePosition(cur_ref_, R) == tensor_->calculatePosition(ite.cur_ref_, R);
+    bool operator== (const ROIteratorOneDim& ite) const{
+        return pos_ == ite.pos_;
     }
 
     /**
      * Disequality comparison
      * @param ite : iterator to be compared with this
-     * @return true if they don't point to the same element in tensor_
+     * @return true if they don't point to the same element
      */
-    bool operator!= (const ROIteratorOneDim& ite){
-        return tensor_->calculatePosition(cur_ref_, R) != tensor_->calculatePosition(ite.cur_ref_, R);
+    bool operator!= (const ROIteratorOneDim& ite) const{
+        return pos_ != ite.pos_;
+    }
+
+    /**
+     * Ordering comparisons, by position along the line
+     * @param ite : iterator to be compared with this
+     * @return
+     */
+    bool operator< (const ROIteratorOneDim& ite) const{
+        return pos_ < ite.pos_;
+    }
+
+    bool operator> (const ROIteratorOneDim& ite) const{
+        return pos_ > ite.pos_;
+    }
+
+    bool operator<= (const ROIteratorOneDim& ite) const{
+        return pos_ <= ite.pos_;
+    }
+
+    bool operator>= (const ROIteratorOneDim& ite) const{
+        return pos_ >= ite.pos_;
     }
 
     /**
      * Dereference operator
-     * @return the value of type T pointed
+     * @return reference to the element pointed, that can be written
+     */
+    T& operator* () const{
+        return base_[pos_ * stride_];
+    }
+
+    T* operator-> () const{
+        return base_ + pos_ * stride_;
+    }
+
+    /**
+     * Subscript operator
+     * @param n : distance from the current element
+     * @return reference to the element n positions after the current one
      */
-    T operator* () {
-        return tensor_->getWithArray(cur_ref_, R);
+    T& operator[] (const difference_type n) const{
+        return base_[(pos_ + n) * stride_];
     }
 
 };
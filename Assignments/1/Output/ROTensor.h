@@ -5,9 +5,13 @@
 #include <iostream>
 #include <tuple>
 #include <memory>
+#include <algorithm>
+#include <utility>
 #include "Utility.h"
 #include "ROIterator.h"
 #include "ROIteratorOneDim.h"
+#include "StridedCopy.h"
+#include "StridedSpan.h"
 #include "NKTensor.h"
 
 using namespace std;
@@ -18,23 +22,27 @@ class RDTensor;
 template <class T, int R = 0>
 class ROTensor {
 private:
-    int dimensions_[R];
-    int strides_[R];
-    shared_ptr<vector<T>> array_;
-    int start_pointer_;
-    int end_pointer_;
+    Index dimensions_[R];
+    Index strides_[R];
+    shared_ptr<Storage<T>> array_;
+    Index start_pointer_;
+    Index end_pointer_;
     friend class ROIterator<T, R>;
+    friend class ROIterator<const T, R>;
     friend class ROIteratorOneDim<T, R>;
+    friend class ROIteratorOneDim<const T, R>;
     // I must impose that tensor with rank R + 1 is a friend because otherwise tensor with rank R + 1 could not do slicing
     friend class ROTensor<T, R + 1>;
     template <class T1, int ... D>
     friend class RDTensor;
+    // for sharing conversions
+    friend class NKTensor<T>;
 
     /**
      * It throws and exception if the element poitend to indexes does not exisit
      * @param indexes : tupla of element
      */
-    inline void checkExistence(const int indexes[], const int dim) const{
+    inline void checkExistence(const Index indexes[], const int dim) const{
         if(dim != R)
             throw invalid_argument("Indexes number not equal to rank");
         for(int i = 0; i< dim; ++i){
@@ -49,7 +57,7 @@ private:
      * @param idx : index number
      * @param val : index value
      */
-    inline void checkIndex(const int idx, const int val) const{
+    inline void checkIndex(const int idx, const Index val) const{
         if(idx<0 || idx>=R || val<0 || val>=dimensions_[idx]){
             throw out_of_range ("Indexes out of range");
         }
@@ -66,18 +74,63 @@ private:
     }
 
     /**
-     * Convert tupla into int to access the array
+     * Position of the first element along an index, the other indexes being fixed.
+     * It throws an exception if those elements do not exist
+     * @param idx : index to scan
+     * @param fixed_values : values of the other indexes
+     * @param dim : number of fixed values
+     * @return position in the array of the first element along idx
+     */
+    inline Index linePosition(const int idx, const Index fixed_values[], const int dim) const{
+        if(idx < 0 || idx >= R)
+            throw out_of_range("Index to scan doesn't exist.");
+        if(dim != R - 1)
+            throw invalid_argument("Indexes number not equal to rank - 1.");
+        Index position = start_pointer_;
+        for(int i = 0; i < dim; ++i){
+            // fixed_values skips idx
+            const int j = i < idx ? i : i + 1;
+            if(fixed_values[i] < 0 || fixed_values[i] >= dimensions_[j]){
+                throw out_of_range("Indexes out of range");
+            }
+            position += strides_[j] * fixed_values[i];
+        }
+        return position;
+    }
+
+    /**
+     * Convert tupla into Index to access the array
      * @param tupla : element indexes
      * @return position index of the element pointed by tupla in the array
      */
-    inline int calculatePosition(const int tupla[], const int dim) const {
-        int position = start_pointer_;
+    inline Index calculatePosition(const Index tupla[], const int dim) const {
+        Index position = start_pointer_;
         for(int i = 0 ; i < dim; ++i){
             position += strides_[i]*tupla[i];
         }
         return position;
     }
 
+    /**
+     * Convert indexes into Index to access the array, unrolled at compile time over R
+     * @param INDEXES : element indexes, one for each dimension
+     * @return position index of the element pointed by INDEXES in the array
+     */
+    template<size_t... I, typename ...Ints>
+    inline Index calculatePosition(index_sequence<I...>, Ints... INDEXES) const {
+        return (start_pointer_ + ... + (strides_[I] * INDEXES));
+    }
+
+    /**
+     * It throws and exception if the element poitend to INDEXES does not exisit, the rank being checked at compile time
+     * @param INDEXES : element indexes, one for each dimension
+     */
+    template<size_t... I, typename ...Ints>
+    inline void checkExistence(index_sequence<I...>, Ints... INDEXES) const {
+        if(((INDEXES < 0 || INDEXES >= dimensions_[I]) || ...))
+            throw out_of_range ("Indexes out of range");
+    }
+
     /**
      * A private constructor used to create a precise new tensor (used for slicing)
      * @param array : pointer to the shared memory where datas are stored
@@ -88,11 +141,11 @@ private:
      * @return
      */
     ROTensor(
-            const shared_ptr<vector<T>>& array,
-            int dimensions[],
-            int strides[],
-            const int start_pointer,
-            const int end_pointer
+            const shared_ptr<Storage<T>>& array,
+            Index dimensions[],
+            Index strides[],
+            const Index start_pointer,
+            const Index end_pointer
     ) : array_ (array),
         start_pointer_(start_pointer),
         end_pointer_(end_pointer)
@@ -108,7 +161,7 @@ public:
      * Default constructor
      * @return new tensor with R dimensions imposed to 1
      */
-    ROTensor() : ROTensor(vector<int>(R,1)){}
+    ROTensor() : ROTensor(vector<Index>(R,1)){}
 
     /**
      * Constructor with parameter pack
@@ -116,25 +169,33 @@ public:
      * @return new tensor with dimensions DIM
      */
     template<typename ...Ints>
-    ROTensor(Ints... DIM) :  ROTensor(vector<int>({DIM...})){}
+    ROTensor(Ints... DIM) :  ROTensor(vector<Index>({DIM...})){}
 
     /**
      * Constructor with vector
      * @param dimensions : vector of int corresponding to tensor dimensions
      * @return new tensor with dimensions dimensions
      */
-    ROTensor(const vector<int>& dimensions) {
+    ROTensor(const vector<int>& dimensions) : ROTensor(vector<Index>(dimensions.begin(), dimensions.end())){}
+
+    /**
+     * Constructor with vector
+     * @param dimensions : vector of Index corresponding to tensor dimensions
+     * @return new tensor with dimensions dimensions
+     * It throws an exception if the number of elements does not fit in an Index
+     */
+    ROTensor(const vector<Index>& dimensions) {
         if (dimensions.size() != R)
             throw invalid_argument("Number of dimensions not equal to " + to_string(R));
-        int element_number = 1;
+        Index element_number = 1;
         for (int i = R - 1; i >= 0; --i) {
             if(dimensions[i] <= 0)
                 throw invalid_argument("Dimensions value must not be equal to 0!");
             dimensions_[i] = dimensions[i];
             strides_[i] = element_number;
-            element_number *= dimensions_[i];
+            element_number = checkedProduct(element_number, dimensions_[i]);
         }
-        array_ = make_shared<vector<T>>(element_number);
+        array_ = make_shared<Storage<T>>(element_number, T());
         start_pointer_ = 0;
         end_pointer_ = element_number;
     }
@@ -172,25 +233,77 @@ public:
      */
     ROTensor& operator=(ROTensor&& ten) = default;
 
+    /**
+     * Sharing Constructor from a tensor of rank known at runtime
+     * @param ten : tensor of rank R whose elements are shared
+     * @return a tensor sharing the elements of ten, with the same dimensions and strides
+     */
+    ROTensor(const NKTensor<T>& ten) :
+            array_(ten.array_),
+            start_pointer_(ten.start_pointer_),
+            end_pointer_(ten.end_pointer_)
+    {
+        if (ten.rank_ != R)
+            throw invalid_argument("Rank not equal to " + to_string(R));
+        for(int i = 0; i < R; ++i){
+            dimensions_[i] = ten.dimensions_[i];
+            strides_[i] = ten.strides_[i];
+        }
+    }
+
+    /**
+     * Sharing Constructor from a tensor with compile-time dimensions
+     * @param ten : tensor of rank R whose elements are shared, stored on the heap
+     * @return a tensor sharing the elements of ten, with the same dimensions
+     */
+    template <int... D>
+    ROTensor(const RDTensor<T, D...>& ten) {
+        static_assert(sizeof...(D) == R, "Rank not equal to the number of dimensions");
+        static_assert(!RDTensor<T, D...>::INLINE, "Inline elements cannot be shared");
+        for(int i = 0; i < R; ++i){
+            dimensions_[i] = RDTensor<T, D...>::dimensions_[i];
+            strides_[i] = RDTensor<T, D...>::strides_[i];
+        }
+        array_ = ten.array_;
+        start_pointer_ = ten.start_pointer_;
+        end_pointer_ = start_pointer_ + RDTensor<T, D...>::SIZE;
+    }
+
+    /**
+     * Sharing Assignment from a tensor of rank known at runtime
+     * @param ten : tensor of rank R whose elements are shared
+     * @return reference to the tensor
+     */
+    ROTensor& operator=(const NKTensor<T>& ten){
+        return *this = ROTensor(ten);
+    }
+
+    /**
+     * Sharing Assignment from a tensor with compile-time dimensions
+     * @param ten : tensor of rank R whose elements are shared
+     * @return reference to the tensor
+     */
+    template <int... D>
+    ROTensor& operator=(const RDTensor<T, D...>& ten){
+        return *this = ROTensor(ten);
+    }
+
     /**
      * This method create a tensor's copy duplicating the array, which contains only those fields concerning the array's portion used by the tensor
      * @return : A tensor's copy
      */
-    ROTensor copy(){
-        int element_number = 1;
-        int new_strides_[R];
+    ROTensor copy() const{
+        Index element_number = 1;
+        Index new_strides_[R];
+        Index new_dimensions_[R];
         for (int i = R - 1; i >= 0 ; --i) {
+            new_dimensions_[i] = dimensions_[i];
             new_strides_[i] = element_number;
             element_number *= dimensions_[i];
         }
-        shared_ptr<vector<T>> new_array = make_shared<vector<T>>(element_number);
-        ROTensor<T,R> copied_tensor_(new_array, dimensions_, new_strides_, 0, dimensions_[0]*strides_[0]);
-        auto j = copied_tensor_.begin();
-        for(auto i = begin(); i < end(); ++i){
-            copied_tensor_.setWithArray(*i, j.currentPosition(), R);
-            ++j;
-        }
-        return copied_tensor_;
+        shared_ptr<Storage<T>> new_array = make_shared<Storage<T>>(element_number);
+        stridedCopy(array_->data() + start_pointer_, dimensions_, strides_, R, new_array->data());
+        return ROTensor<T,R>(new_array, new_dimensions_, new_strides_, (Index)0, element_number);
     }
 
     /**
@@ -200,8 +313,9 @@ public:
      */
     template<typename ...Ints>
     inline T get(Ints... INDEXES) const{
-        int idxs[] = {INDEXES...};
-        return getWithArray(idxs, (int)sizeof...(INDEXES));
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        checkExistence(make_index_sequence<R>(), INDEXES...);
+        return (*array_)[calculatePosition(make_index_sequence<R>(), INDEXES...)];
     }
 
     /**
@@ -209,27 +323,69 @@ public:
      * @param indexes : position to be read
      * @return value pointed by indexes
      */
-    inline T getWithArray(const int indexes[], const int dim) const{
-        try{
-            checkExistence(indexes, dim);
-        }
-        catch(invalid_argument e){
-            throw e;
-        }
-        catch(out_of_range e){
-            throw e;
-        }
-        return array_->at(calculatePosition(indexes, dim));
+    inline T getWithArray(const Index indexes[], const int dim) const{
+        checkExistence(indexes, dim);
+        return (*array_)[calculatePosition(indexes, dim)];
     }
 
     /**
-     * Like get
+     * Get an element without checking the indexes, unless CHECK_ACCESS is set
      * @param INDEXES : position to be read
-     * @return value pointed by indexes
+     * @return value pointed by INDEXES
+     */
+    template<typename ...Ints>
+    inline T getUnchecked(Ints... INDEXES) const{
+        return (*this)(INDEXES...);
+    }
+
+    /**
+     * Access an element without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position of the element
+     * @return reference to the element, so that it can be updated in place, e.g. t(i, j) += x
+     */
+    template<typename ...Ints>
+    inline T& operator()(Ints... INDEXES){
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        if(CHECK_ACCESS)
+            checkExistence(make_index_sequence<R>(), INDEXES...);
+        return (*array_)[calculatePosition(make_index_sequence<R>(), INDEXES...)];
+    }
+
+    /**
+     * Access an element of a const tensor without checking the indexes, unless CHECK_ACCESS is set
+     * @param INDEXES : position of the element
+     * @return reference to the element
+     */
+    template<typename ...Ints>
+    inline const T& operator()(Ints... INDEXES) const{
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        if(CHECK_ACCESS)
+            checkExistence(make_index_sequence<R>(), INDEXES...);
+        return (*array_)[calculatePosition(make_index_sequence<R>(), INDEXES...)];
+    }
+
+    /**
+     * Access an element
+     * @param INDEXES : position of the element
+     * @return reference to the element, so that it can be updated in place
+     */
+    template<typename ...Ints>
+    inline T& at(Ints... INDEXES){
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        checkExistence(make_index_sequence<R>(), INDEXES...);
+        return (*array_)[calculatePosition(make_index_sequence<R>(), INDEXES...)];
+    }
+
+    /**
+     * Access an element of a const tensor
+     * @param INDEXES : position of the element
+     * @return reference to the element
      */
     template<typename ...Ints>
-    inline T operator()(Ints... INDEXES){
-        return get(INDEXES...);
+    inline const T& at(Ints... INDEXES) const{
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        checkExistence(make_index_sequence<R>(), INDEXES...);
+        return (*array_)[calculatePosition(make_index_sequence<R>(), INDEXES...)];
     }
 
     /**
@@ -239,9 +395,9 @@ public:
      */
     template<typename ...Ints>
     inline void set(const T& value, Ints... INDEXES){
-        int idxs[] = {INDEXES...};
-        //vector<int> idxs ={INDEXES...};
-        setWithArray(value, idxs, (int)sizeof...(INDEXES));
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        checkExistence(make_index_sequence<R>(), INDEXES...);
+        (*array_)[calculatePosition(make_index_sequence<R>(), INDEXES...)] = value;
     }
 
     /**
@@ -249,17 +405,22 @@ public:
      * @param value : new value of the element
      * @param indexes : tupla of element to be setted
      */
-    inline void setWithArray(const T& value, const int indexes[], const int dim){
-        try{
-            checkExistence(indexes, dim);
-        }
-        catch(invalid_argument e){
-            throw e;
-        }
-        catch(out_of_range e){
-            throw e;
-        }
-        array_->at(calculatePosition(indexes, dim)) = value;
+    inline void setWithArray(const T& value, const Index indexes[], const int dim){
+        checkExistence(indexes, dim);
+        (*array_)[calculatePosition(indexes, dim)] = value;
+    }
+
+    /**
+     * Set an element value without checking the indexes, unless CHECK_ACCESS is set
+     * @param value : new value of the element
+     * @param INDEXES : tupla of element to be setted
+     */
+    template<typename ...Ints>
+    inline void setUnchecked(const T& value, Ints... INDEXES){
+        static_assert(sizeof...(INDEXES) == R, "Indexes number not equal to rank");
+        if(CHECK_ACCESS)
+            checkExistence(make_index_sequence<R>(), INDEXES...);
+        (*array_)[calculatePosition(make_index_sequence<R>(), INDEXES...)] = value;
     }
 
     /**
@@ -268,7 +429,7 @@ public:
      * @param val : is the value assigned to the index
      * @return new sliced tensor
      */
-    inline ROTensor<T, R - 1> slicing(const int idx, const int val) {
+    inline ROTensor<T, R - 1> slicing(const int idx, const Index val) {
         try{
             checkIndex(idx,val);
         }
@@ -276,11 +437,11 @@ public:
             throw (e);
         }
         if(R - 1 == 0){
-            return ROTensor<T,R - 1>(array_,(int *)NULL,(int *)NULL,start_pointer_ + val * strides_[idx],(int)NULL);
+            return ROTensor<T,R - 1>(array_,(Index *)NULL,(Index *)NULL,start_pointer_ + val * strides_[idx],(Index)0);
         }
         else{
-            int new_dimensions_[R - 1];
-            int new_strides_[R - 1];
+            Index new_dimensions_[R - 1];
+            Index new_strides_[R - 1];
             for(int i = 0; i < R; ++i){
                 if(i < idx){
                     new_dimensions_[i] = dimensions_[i];
@@ -290,8 +451,8 @@ public:
                     new_strides_[i - 1] = strides_[i];
                 }
             }
-            int new_start_pointer_ = start_pointer_ + val * strides_[idx];
-            int new_end_pointer_ = new_start_pointer_ + new_dimensions_[0] * new_strides_[0];
+            Index new_start_pointer_ = start_pointer_ + val * strides_[idx];
+            Index new_end_pointer_ = new_start_pointer_ + new_dimensions_[0] * new_strides_[0];
             return ROTensor<T, R - 1>(array_,new_dimensions_,new_strides_,new_start_pointer_,new_end_pointer_);
         }
     }
@@ -301,7 +462,7 @@ public:
      * @param val
      * @return
      */
-    ROTensor<T, R - 1> operator[](const int val) {
+    ROTensor<T, R - 1> operator[](const Index val) {
         try{
             return slicing(0, val);
         }
@@ -315,9 +476,9 @@ public:
      * @param idx_val
      * @return new sliced NKTensor
      */
-    inline NKTensor<T> slicing(const vector<pair<int,int>>& idx_val) const {
-        vector<int> new_dimensions_;
-        vector<int> new_strides_;
+    inline NKTensor<T> slicing(const vector<pair<int,Index>>& idx_val) const {
+        vector<Index> new_dimensions_;
+        vector<Index> new_strides_;
         for(int i = 0; i < R; ++i){
             new_dimensions_.push_back(dimensions_[i]);
             new_strides_.push_back(strides_[i]);
@@ -333,7 +494,7 @@ public:
      * @param max : max index value used for windowing
      * @return New windowed Tensor
      */
-    inline ROTensor<T,R> windowing(const int idx, const int min, const int max){
+    inline ROTensor<T,R> windowing(const int idx, const Index min, const Index max){
         try{
             checkIndex(idx,min);
             checkIndex(idx,max);
@@ -344,16 +505,16 @@ public:
         if(min>max){
             throw invalid_argument("Min value is greater than max value. No possible operations.");
         }
-        int new_dimensions_[R];
-        int new_strides_[R];
+        Index new_dimensions_[R];
+        Index new_strides_[R];
         for(int i = 0; i < R; ++i){
             new_dimensions_[i] = dimensions_[i];
             new_strides_[i] = strides_[i];
         }
         new_dimensions_[idx] = max - min + 1;
-        shared_ptr<vector<T>> new_array_ = array_;
-        int new_start_pointer_ = start_pointer_ + strides_[idx] * min;
-        int new_end_pointer_ = new_start_pointer_ + strides_[0] * new_dimensions_[0];
+        shared_ptr<Storage<T>> new_array_ = array_;
+        Index new_start_pointer_ = start_pointer_ + strides_[idx] * min;
+        Index new_end_pointer_ = new_start_pointer_ + strides_[0] * new_dimensions_[0];
         ROTensor<T,R> new_tensor(new_array_,new_dimensions_,new_strides_,new_start_pointer_,new_end_pointer_);
         return new_tensor;
     }
@@ -365,7 +526,7 @@ public:
      * same because windowing doesn't decrease the rank.
      * @return New Tensor windowed multiple times
      */
-    inline ROTensor<T,R> windowing(const vector<tuple<int,int,int>>& t){
+    inline ROTensor<T,R> windowing(const vector<tuple<int,Index,Index>>& t){
         ROTensor<T,R> tmp (*this);
         for(int i=0;i<t.size();++i){
             tmp = tmp.windowing(std::get<0>(t[i]), std::get<1>(t[i]), std::get<2>(t[i]));
@@ -379,8 +540,8 @@ public:
      * @return new Tensor on which it has been applied the flattening operation multiple times
      */
     inline NKTensor<T> flattening(const int min, const int max){
-        vector<int> new_dimensions_;
-        vector<int> new_strides_;
+        vector<Index> new_dimensions_;
+        vector<Index> new_strides_;
         for(int i = 0; i < R; ++i){
             new_dimensions_.push_back(dimensions_[i]);
             new_strides_.push_back(strides_[i]);
@@ -398,6 +559,15 @@ public:
         return iter;
     }
 
+    /**
+     * Begin iterator of a const tensor
+     * @return read-only iterator to the begin point
+     */
+    ROIterator<const T, R> begin() const{
+        ROIterator<const T, R> iter(*this, true);
+        return iter;
+    }
+
     /**
      * End iterator
      * @return iterator to the end point
@@ -407,36 +577,47 @@ public:
         return iter;
     }
 
+    /**
+     * End iterator of a const tensor
+     * @return read-only iterator to the end point
+     */
+    ROIterator<const T, R> end() const{
+        ROIterator<const T, R> iter(*this, false);
+        return iter;
+    }
+
     /**
      * Begin iterator of the tensor on only one dimension
      * @param idx : dimension to iterate
      * @param fixed_values : fixed values of other dimensions
      * @return iterator on dimension idx
      */
-    ROIteratorOneDim<T, R> beginWithArray(const int idx, const int fixed_values[], const int dim) const {
-        try{
-            return ROIteratorOneDim<T, R>(*this, true, idx, fixed_values, dim);
-        }
-        catch (out_of_range e){
-            throw e;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
+    ROIteratorOneDim<T, R> beginWithArray(const int idx, const Index fixed_values[], const int dim) {
+        const Index position = linePosition(idx, fixed_values, dim);
+        return ROIteratorOneDim<T, R>(array_->data() + position, strides_[idx], 0);
     }
 
     template <typename... Ints>
-    ROIteratorOneDim<T, R> begin(const int idx, Ints... INDEXES) const {
-        int fv[] = {INDEXES...};
-        try{
-            return beginWithArray(idx, fv, sizeof...(INDEXES));
-        }
-        catch (out_of_range e){
-            throw e;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
+    ROIteratorOneDim<T, R> begin(const int idx, Ints... INDEXES) {
+        const Index fv[] = {INDEXES..., 0};
+        return beginWithArray(idx, fv, sizeof...(INDEXES));
+    }
+
+    /**
+     * Begin iterator of a const tensor on only one dimension
+     * @param idx : dimension to iterate
+     * @param fixed_values : fixed values of other dimensions
+     * @return read-only iterator on dimension idx
+     */
+    ROIteratorOneDim<const T, R> beginWithArray(const int idx, const Index fixed_values[], const int dim) const {
+        const Index position = linePosition(idx, fixed_values, dim);
+        return ROIteratorOneDim<const T, R>(array_->data() + position, strides_[idx], 0);
+    }
+
+    template <typename... Ints>
+    ROIteratorOneDim<const T, R> begin(const int idx, Ints... INDEXES) const {
+        const Index fv[] = {INDEXES..., 0};
+        return beginWithArray(idx, fv, sizeof...(INDEXES));
     }
 
     /**
@@ -445,30 +626,68 @@ public:
      * @param fixed_values : fixed values of other dimensions
      * @return iterator on dimension idx
      */
-    ROIteratorOneDim<T, R> endWithArray(const int idx, const int fixed_values[], const int dim){
-        try{
-            return ROIteratorOneDim<T, R>(*this, false, idx, fixed_values, dim);
-        }
-        catch (out_of_range e){
-            throw e;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
+    ROIteratorOneDim<T, R> endWithArray(const int idx, const Index fixed_values[], const int dim) {
+        ROIteratorOneDim<T, R> iter = beginWithArray(idx, fixed_values, dim);
+        iter.pos_ = dimensions_[idx];
+        return iter;
     }
 
     template <typename... Ints>
-    ROIteratorOneDim<T, R> end(const int idx, Ints... fixed_values){
-        int fv[] = {fixed_values...};
-        try{
-            return endWithArray(idx, fv, sizeof...(fixed_values));
-        }
-        catch (out_of_range e){
-            throw e;
-        }
-        catch (invalid_argument e){
-            throw e;
-        }
+    ROIteratorOneDim<T, R> end(const int idx, Ints... fixed_values) {
+        const Index fv[] = {fixed_values..., 0};
+        return endWithArray(idx, fv, sizeof...(fixed_values));
+    }
+
+    /**
+     * End iterator of a const tensor on only one dimension
+     * @param idx : dimension to iterate
+     * @param fixed_values : fixed values of other dimensions
+     * @return read-only iterator on dimension idx
+     */
+    ROIteratorOneDim<const T, R> endWithArray(const int idx, const Index fixed_values[], const int dim) const {
+        ROIteratorOneDim<const T, R> iter = beginWithArray(idx, fixed_values, dim);
+        iter.pos_ = dimensions_[idx];
+        return iter;
+    }
+
+    template <typename... Ints>
+    ROIteratorOneDim<const T, R> end(const int idx, Ints... fixed_values) const {
+        const Index fv[] = {fixed_values..., 0};
+        return endWithArray(idx, fv, sizeof...(fixed_values));
+    }
+
+    /**
+     * Elements along one dimension, to be accessed by position as in a plain array
+     * @param idx : dimension to scan
+     * @param fixed_values : fixed values of other dimensions
+     * @return span over the elements along idx, that must not outlive them
+     */
+    StridedSpan<T> spanWithArray(const int idx, const Index fixed_values[], const int dim) {
+        const Index position = linePosition(idx, fixed_values, dim);
+        return StridedSpan<T>(array_->data() + position, strides_[idx], dimensions_[idx]);
+    }
+
+    template <typename... Ints>
+    StridedSpan<T> span(const int idx, Ints... fixed_values) {
+        const Index fv[] = {fixed_values..., 0};
+        return spanWithArray(idx, fv, sizeof...(fixed_values));
+    }
+
+    /**
+     * Elements of a const tensor along one dimension, to be read by position as in a plain array
+     * @param idx : dimension to scan
+     * @param fixed_values : fixed values of other dimensions
+     * @return read-only span over the elements along idx, that must not outlive them
+     */
+    StridedSpan<const T> spanWithArray(const int idx, const Index fixed_values[], const int dim) const {
+        const Index position = linePosition(idx, fixed_values, dim);
+        return StridedSpan<const T>(array_->data() + position, strides_[idx], dimensions_[idx]);
+    }
+
+    template <typename... Ints>
+    StridedSpan<const T> span(const int idx, Ints... fixed_values) const {
+        const Index fv[] = {fixed_values..., 0};
+        return spanWithArray(idx, fv, sizeof...(fixed_values));
     }
 
     /**
@@ -508,8 +727,8 @@ public:
 template <class T>
 class ROTensor<T,0>{
 private:
-    shared_ptr<vector<T>> array_;
-    int start_pointer_ = 0;
+    shared_ptr<Storage<T>> array_;
+    Index start_pointer_ = 0;
     // I must impose that tensor with rank 1 is a friend because otherwise tensor with rank 1 could not do slicing
     friend class ROTensor<T, 1>;
     template <class T1, int ... D>
@@ -521,7 +740,7 @@ private:
      * @param start_pointer
      * @return
      */
-    ROTensor(const shared_ptr<vector<T>> array, const int start_pointer) : array_(array), start_pointer_(start_pointer) {}
+    ROTensor(const shared_ptr<Storage<T>> array, const Index start_pointer) : array_(array), start_pointer_(start_pointer) {}
 
     /**
      * A private constructor used to create a precise new tensor (used for slicing)
@@ -533,11 +752,11 @@ private:
      * @return
      */
     ROTensor(
-            const shared_ptr<vector<T>>& array,
-            const int dimensions[],
-            const int strides[],
-            int start_pointer,
-            int end_pointer
+            const shared_ptr<Storage<T>>& array,
+            const Index dimensions[],
+            const Index strides[],
+            Index start_pointer,
+            Index end_pointer
     ) : array_(array), start_pointer_(start_pointer) {}
 
 public:
@@ -546,7 +765,7 @@ public:
      * @return new tensor with rank 0 (like a variable)
      */
     ROTensor() {
-        array_ = make_shared<vector<T>>(1);
+        array_ = make_shared<Storage<T>>(1, T());
     }
 
     /**
@@ -634,6 +853,44 @@ public:
         array_->at(start_pointer_) = value;
     }
 
+    /**
+     * Access the element
+     * @return reference to the element, so that it can be updated in place, e.g. t() += x
+     */
+    inline T& operator()(){
+        return (*array_)[start_pointer_];
+    }
+
+    /**
+     * Access the element of a const tensor
+     * @return reference to the element
+     */
+    inline const T& operator()() const{
+        return (*array_)[start_pointer_];
+    }
+
+    /**
+     * Access the element, checking that it exists
+     * @return reference to the element, so that it can be updated in place
+     */
+    inline T& at(){
+        if (array_ == nullptr){
+            throw out_of_range ("Indexes out of range");
+        }
+        return (*array_)[start_pointer_];
+    }
+
+    /**
+     * Access the element of a const tensor, checking that it exists
+     * @return reference to the element
+     */
+    inline const T& at() const{
+        if (array_ == nullptr){
+            throw out_of_range ("Indexes out of range");
+        }
+        return (*array_)[start_pointer_];
+    }
+
     /**
      * Only for debug
      * @param name
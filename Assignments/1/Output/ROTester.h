@@ -3,6 +3,11 @@
 
 #include "ROTensor.h"
 #include <time.h>
+#include <chrono>
+#include <algorithm>
+#if __has_include(<execution>)
+#include <execution>
+#endif
 
 using namespace std;
 
@@ -40,6 +45,18 @@ public:
 
         cout << "Average time with ROTensor<char,2> tensor(1000, 1000): " << sum/num_test << " ms" << endl;
 
+        sum = 0;
+        for(int i = 0; i < num_test; ++i){
+            const clock_t start = clock();
+            for(int r= 0; r < 1000; ++r)
+                for(int c = 0; c < 1000; ++c)
+                    tensor.setUnchecked('a', r, c);
+            const clock_t end = clock();
+            sum += 1000.0 * (end-start) / CLOCKS_PER_SEC;
+        }
+
+        cout << "Average time with ROTensor<char,2> tensor(1000, 1000) and setUnchecked: " << sum/num_test << " ms" << endl;
+
         cout << endl;
         cout << "ROTENSOR : Access test 2 --> Using operator [] (slicing)"<< endl;
 
@@ -79,6 +96,68 @@ public:
         }
         cout << "Average time with char[1000][1000]: " << sum/num_test << " ms" << endl;
 
+        sum = 0;
+        for(int i = 0; i < num_test; ++i){
+            const clock_t start = clock();
+            for(auto it = tensor.begin(); it != tensor.end(); ++it)
+                *it = 'a';
+            const clock_t end = clock();
+            sum += 1000.0 * (end-start) / CLOCKS_PER_SEC;
+        }
+        cout << "Average time with ROTensor<char,2> tensor(1000, 1000): " << sum/num_test << " ms" << endl;
+
+        // clock() adds up the time of all the threads, so the parallel algorithm is timed on the wall clock
+        sum = 0;
+        for(int i = 0; i < num_test; ++i){
+            const auto start = chrono::steady_clock::now();
+#if defined(__cpp_lib_execution)
+            for_each(execution::par_unseq, tensor.begin(), tensor.end(), [](char& c){ c = 'a'; });
+#else
+            for_each(tensor.begin(), tensor.end(), [](char& c){ c = 'a'; });
+#endif
+            const auto end = chrono::steady_clock::now();
+            sum += chrono::duration<double, milli>(end-start).count();
+        }
+        cout << "Average time with ROTensor<char,2> tensor(1000, 1000) and for_each(par_unseq): " << sum/num_test << " ms" << endl;
+
+        cout << endl;
+        cout << "ROTENSOR : Access test 4 --> Using span along the second index"<< endl;
+
+        sum = 0;
+        for(int i = 0; i < num_test; ++i){
+            const clock_t start = clock();
+            for(int r= 0; r < 1000; ++r){
+                StridedSpan<char> row = tensor.span(1, r);
+                for(int c = 0; c < 1000; ++c)
+                    row[c] = 'a';
+            }
+            const clock_t end = clock();
+            sum += 1000.0 * (end-start) / CLOCKS_PER_SEC;
+        }
+        cout << "Average time with ROTensor<char,2> tensor(1000, 1000): " << sum/num_test << " ms" << endl;
+
+        cout << endl;
+        cout << "ROTENSOR : Copy test --> Using copy function"<< endl;
+
+        sum = 0;
+        for(int i = 0; i < num_test; ++i){
+            const clock_t start = clock();
+            tensor.copy();
+            const clock_t end = clock();
+            sum += 1000.0 * (end-start) / CLOCKS_PER_SEC;
+        }
+        cout << "Average time with ROTensor<char,2> tensor(1000, 1000): " << sum/num_test << " ms" << endl;
+
+        auto window = tensor.windowing(1, 1, 998);
+        sum = 0;
+        for(int i = 0; i < num_test; ++i){
+            const clock_t start = clock();
+            window.copy();
+            const clock_t end = clock();
+            sum += 1000.0 * (end-start) / CLOCKS_PER_SEC;
+        }
+        cout << "Average time with ROTensor<char,2> tensor(1000, 1000) windowed on the second index: " << sum/num_test << " ms" << endl;
+
     }
 };
 
@@ -0,0 +1,138 @@
+#ifndef TENSORLIBRARY_STRIDEDCOPY_H
+#define TENSORLIBRARY_STRIDEDCOPY_H
+
+#include <vector>
+#include <thread>
+#include <system_error>
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
+#include "Utility.h"
+
+using namespace std;
+
+/*Bulk copy of the elements of a strided tensor into a contiguous array, in row-major order, used by copy().
+Indexes whose elements are contiguous in memory are merged first, so that the innermost loop moves whole runs with
+memcpy, while windowed and sliced tensors are walked run by run with their strides. Large copies are split among
+threads*/
+
+// copies smaller than this are done by the calling thread alone
+constexpr Index PARALLEL_COPY_BYTES = Index(1) << 24;
+
+/**
+ * Copy a run of elements along the innermost index
+ * @param src : first element of the run
+ * @param stride : distance between two elements of the run
+ * @param length : number of elements
+ * @param dst : where the run is written, contiguously
+ */
+template<class T>
+inline void copyRun(const T* src, const Index stride, const Index length, T* dst){
+    if(stride == 1){
+        if constexpr (is_trivially_copyable<T>::value)
+            memcpy(dst, src, length * sizeof(T));
+        else
+            std::copy(src, src + length, dst);
+    }
+    else{
+        for(Index i = 0; i < length; ++i){
+            dst[i] = src[i * stride];
+        }
+    }
+}
+
+/**
+ * Copy the elements from position first to position last, in row-major order
+ * @param src : first element of the tensor
+ * @param dimensions : merged dimensions, at least one
+ * @param strides : merged strides
+ * @param dst : first element of the destination
+ * @param first : row-major position of the first element to be copied
+ * @param last : row-major position after the last element to be copied
+ */
+template<class T>
+void copyRange(const T* src, const vector<Index>& dimensions, const vector<Index>& strides, T* dst,
+               Index first, const Index last){
+    const int rank = dimensions.size();
+    vector<Index> cur_ref(rank);
+    Index rest = first;
+    for(int i = rank - 1; i >= 0; --i){
+        cur_ref[i] = rest % dimensions[i];
+        rest /= dimensions[i];
+        src += strides[i] * cur_ref[i];
+    }
+    while(first < last){
+        const Index length = min(dimensions[rank - 1] - cur_ref[rank - 1], last - first);
+        copyRun(src, strides[rank - 1], length, dst + first);
+        first += length;
+        cur_ref[rank - 1] += length;
+        src += strides[rank - 1] * length;
+        for(int i = rank - 1; i > 0 && cur_ref[i] == dimensions[i]; --i){
+            cur_ref[i] = 0;
+            src -= strides[i] * dimensions[i];
+            ++cur_ref[i - 1];
+            src += strides[i - 1];
+        }
+    }
+}
+
+/**
+ * Copy all the elements of a tensor, in row-major order
+ * @param src : first element of the tensor
+ * @param dimensions : dimensions of the tensor
+ * @param strides : strides of the tensor
+ * @param rank : rank of the tensor, 0 for a single element
+ * @param dst : destination, with room for all the elements
+ */
+template<class T>
+void stridedCopy(const T* src, const Index dimensions[], const Index strides[], const int rank, T* dst){
+    // an index can be merged with the previous one when they step through memory as a single index
+    vector<Index> merged_dimensions;
+    vector<Index> merged_strides;
+    Index element_number = 1;
+    for(int i = 0; i < rank; ++i){
+        element_number *= dimensions[i];
+        if(dimensions[i] == 1)
+            continue;
+        if(!merged_dimensions.empty() && merged_strides.back() == strides[i] * dimensions[i]){
+            merged_dimensions.back() *= dimensions[i];
+            merged_strides.back() = strides[i];
+        }
+        else{
+            merged_dimensions.push_back(dimensions[i]);
+            merged_strides.push_back(strides[i]);
+        }
+    }
+    if(merged_dimensions.empty()){
+        merged_dimensions.push_back(1);
+        merged_strides.push_back(1);
+    }
+
+    // threads are used only for plain data, whose copy cannot throw
+    Index threads = thread::hardware_concurrency();
+    if(!is_trivially_copyable<T>::value || element_number * (Index)sizeof(T) < PARALLEL_COPY_BYTES || threads < 2){
+        copyRange(src, merged_dimensions, merged_strides, dst, 0, element_number);
+        return;
+    }
+    threads = min(threads, element_number * (Index)sizeof(T) / PARALLEL_COPY_BYTES + 1);
+    const Index chunk = (element_number + threads - 1) / threads;
+    vector<thread> workers;
+    for(Index t = 1; t < threads; ++t){
+        const Index first = t * chunk;
+        const Index last = min(element_number, first + chunk);
+        if(first >= last)
+            break;
+        try{
+            workers.emplace_back(copyRange<T>, src, cref(merged_dimensions), cref(merged_strides), dst, first, last);
+        }
+        catch(const system_error& e){
+            copyRange(src, merged_dimensions, merged_strides, dst, first, last);
+        }
+    }
+    copyRange(src, merged_dimensions, merged_strides, dst, 0, min(chunk, element_number));
+    for(auto& worker : workers){
+        worker.join();
+    }
+}
+
+#endif //TENSORLIBRARY_STRIDEDCOPY_H
@@ -0,0 +1,77 @@
+#ifndef TENSORLIBRARY_STRIDEDSPAN_H
+#define TENSORLIBRARY_STRIDEDSPAN_H
+
+#include <stdexcept>
+#include "Utility.h"
+
+using namespace std;
+
+/*Elements of a tensor along one index, the other indexes being fixed: the first element, the stride of the index and
+the number of elements. Accessing an element is a single multiply-add on a plain pointer, so that loops over a span can
+be vectorized by the compiler. The span refers to the elements of the tensor, so it must not outlive them*/
+template<class T>
+class StridedSpan {
+private:
+    T* data_; // first element
+    Index stride_; // distance between two elements
+    Index size_; // number of elements
+
+public:
+    /**
+     * Default constructor
+     * @return empty span
+     */
+    StridedSpan() : data_(nullptr), stride_(1), size_(0) {}
+
+    /**
+     * Constructor
+     * @param data : first element
+     * @param stride : distance between two elements
+     * @param size : number of elements
+     * @return span over size elements, stride apart
+     */
+    StridedSpan(T* data, const Index stride, const Index size) : data_(data), stride_(stride), size_(size) {}
+
+    /**
+     * Access an element without checking the index
+     * @param i : position of the element along the span
+     * @return reference to the element
+     */
+    inline T& operator[](const Index i) const{
+        return data_[i * stride_];
+    }
+
+    /**
+     * Access an element
+     * @param i : position of the element along the span
+     * @return reference to the element
+     */
+    inline T& at(const Index i) const{
+        if(i < 0 || i >= size_)
+            throw out_of_range("Indexes out of range");
+        return data_[i * stride_];
+    }
+
+    /**
+     * @return number of elements
+     */
+    inline Index size() const{
+        return size_;
+    }
+
+    /**
+     * @return distance between two elements, 1 if they are contiguous
+     */
+    inline Index stride() const{
+        return stride_;
+    }
+
+    /**
+     * @return pointer to the first element
+     */
+    inline T* data() const{
+        return data_;
+    }
+};
+
+#endif //TENSORLIBRARY_STRIDEDSPAN_H
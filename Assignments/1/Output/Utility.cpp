@@ -1,7 +1,16 @@
 #include "Utility.h"
+#include <limits>
+#include <stdexcept>
+
+/*Used to compute the number of elements of a tensor: it throws an exception if it does not fit in an Index*/
+Index checkedProduct(const Index a, const Index b){
+    if(b != 0 && a > numeric_limits<Index>::max() / b)
+        throw overflow_error("Too many elements: the tensor size does not fit in 64 bit");
+    return a * b;
+}
 
 /*Used to print vectors content*/
-void showVector(vector<int>& v){
+void showVector(vector<Index>& v){
     cout << "{";
     for(auto i = v.begin(); i < v.end(); ++i){
         cout <<  *i;
@@ -11,7 +20,7 @@ void showVector(vector<int>& v){
     cout << "}";
 }
 
-void showVector(int v[], int dim){
+void showVector(Index v[], int dim){
     cout << "{";
     for(int i = 0; i < dim; ++i){
         cout <<  v[i];
@@ -5,12 +5,60 @@
 #include <iostream>
 #include <tuple>
 #include <memory>
+#include <cstdint>
+#include <new>
+#include <utility>
 
 using namespace std;
 
 /*This file contains all utility function signatures used in the whole project*/
-void showVector(vector<int>& v);
-void showVector(int v[], int dim);
+
+/*Checking policy of the unchecked accessors (operator(), getUnchecked, setUnchecked): compiling with
+TENSORLIBRARY_DEBUG defined makes them check indexes as get and set do*/
+#ifdef TENSORLIBRARY_DEBUG
+constexpr bool CHECK_ACCESS = true;
+#else
+constexpr bool CHECK_ACCESS = false;
+#endif
+
+/*Type of dimensions, strides, indexes and positions of the elements: 64 bit, so that tensors can have more than 2^31
+elements*/
+typedef int64_t Index;
+
+/*Allocator of the element arrays: elements built without a value are default-initialized, so the elements of plain
+types are left uninitialized. New tensors ask for value-initialized elements explicitly, copies leave the fresh array
+to be entirely overwritten by stridedCopy*/
+template<class T>
+struct DefaultInitAllocator : allocator<T> {
+    template<class U>
+    struct rebind {
+        typedef DefaultInitAllocator<U> other;
+    };
+
+    DefaultInitAllocator() = default;
+
+    template<class U>
+    DefaultInitAllocator(const DefaultInitAllocator<U>&) noexcept {}
+
+    template<class U>
+    void construct(U* p) noexcept(is_nothrow_default_constructible<U>::value){
+        ::new((void*)p) U;
+    }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args){
+        ::new((void*)p) U(std::forward<Args>(args)...);
+    }
+};
+
+/*Array of the elements, shared by the tensors that view them*/
+template<class T>
+using Storage = vector<T, DefaultInitAllocator<T>>;
+
+Index checkedProduct(const Index a, const Index b);
+
+void showVector(vector<Index>& v);
+void showVector(Index v[], int dim);
 
 #endif //TENSORLIBRARY_UTILITY_H
 
@@ -1,5 +1,6 @@
 #include "NKTester.h"
 #include "ROTester.h"
+#include "RDTester.h"
 
 int main() {
     cout << "-------------------------------------" << endl;
@@ -20,6 +21,12 @@ int main() {
         cout << "------------------------" << endl << endl;
         rotest.testPerformance();
 
+        RDTester rdtest;
+        cout << endl << "------------------------" << endl;
+        cout << "[3] Performance RDTensor" << endl;
+        cout << "------------------------" << endl << endl;
+        rdtest.testPerformance();
+
         cout << endl << ">> Nessun errore!"<< endl;
     }
     catch(exception e){
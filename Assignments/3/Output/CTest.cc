@@ -11,6 +11,183 @@ std::ostream & operator << (std::ostream& out, Index_Set<id, ids...>) {
     return out << id << ' ' << Index_Set<ids...>();
 }
 
+// correctness checks: the kernels of the contraction planner are compared element by element with
+// the generic loop nest of the baseline evaluator. An extra factor one(l)*one(l) over a width-1
+// repeated index keeps the reference expression away from the planner. The number of workers is set
+// directly, so that the parallel paths are checked whatever the number of cores
+int failures = 0;
+
+template<class X>
+void fill_values(X& t, int seed) {
+    int count = seed;
+    for(auto iter=t.begin(); iter!=t.end(); ++iter)
+        *iter = (count++)%7 - 3;
+}
+
+template<class RESULT, class REFERENCE>
+void check_equal(const char* name, RESULT& result, REFERENCE& reference) {
+    bool equal = true;
+    auto ref = reference.begin();
+    for(auto iter=result.begin(); iter!=result.end(); ++iter, ++ref)
+        equal = equal && *iter==*ref;
+    std::cout << name << (equal ? ": passed" : ": FAILED") << std::endl;
+    if(!equal) ++failures;
+}
+
+void check_multiplication(int nw = 1){
+    NW = nw;
+    auto i=new_index;
+    auto j=new_index;
+    auto k=new_index;
+    auto l=new_index;
+    tensor<int,rank<1>> one(1);
+    one[0] = 1;
+    tensor<int,rank<2>> t1(37,23), t2(23,19), tres(37,19), tref(37,19);
+    fill_values(t1, 0);
+    fill_values(t2, 5);
+
+    tres(i,j)=t1(i,k)*t2(k,j);
+    tref(i,j)=t1(i,k)*t2(k,j)*one(l)*one(l);
+    check_equal("Matrix product 37x23 * 23x19", tres, tref);
+}
+
+void check_batch_multiplication(int nw = 1){
+    NW = nw;
+    auto b=new_index;
+    auto i=new_index;
+    auto j=new_index;
+    auto k=new_index;
+    auto l=new_index;
+    tensor<int,rank<1>> one(1);
+    one[0] = 1;
+
+    // more batch items than workers: each worker takes whole items
+    tensor<int,rank<3>> t1(7,5,3), t2(7,3,9), tres(7,5,9), tref(7,5,9);
+    fill_values(t1, 0);
+    fill_values(t2, 3);
+    tres(b,i,j)=t1(b,i,k)*t2(b,k,j);
+    tref(b,i,j)=t1(b,i,k)*t2(b,k,j)*one(l)*one(l);
+    check_equal("Batch product 7x(5x3 * 3x9)", tres, tref);
+
+    // fewer batch items than workers: the rows of every item are split across the workers
+    tensor<int,rank<3>> t3(2,65,33), t4(2,33,41), tres2(2,65,41), tref2(2,65,41);
+    fill_values(t3, 1);
+    fill_values(t4, 2);
+    tres2(b,i,j)=t3(b,i,k)*t4(b,k,j);
+    tref2(b,i,j)=t3(b,i,k)*t4(b,k,j)*one(l)*one(l);
+    check_equal("Batch product 2x(65x33 * 33x41)", tres2, tref2);
+}
+
+void check_strassen_multiplication(int nw = 1){
+    NW = nw;
+    auto i=new_index;
+    auto j=new_index;
+    auto k=new_index;
+    auto l=new_index;
+    tensor<int,rank<1>> one(1);
+    one[0] = 1;
+    // 75 is padded to 80 = 10*2^3 with blocks of at most 16: integer products are exact
+    tensor<int,rank<2>> t1(75,75), t2(75,75), tres(75,75), tref(75,75);
+    fill_values(t1, 0);
+    fill_values(t2, 4);
+
+    set_strassen(true, 16);
+    tres(i,j)=t1(i,k)*t2(k,j);
+    set_strassen(false);
+    tref(i,j)=t1(i,k)*t2(k,j)*one(l)*one(l);
+    check_equal("Strassen-Winograd product 75x75 * 75x75", tres, tref);
+}
+
+void check_matrix_vector_multiplication(int nw = 1){
+    NW = nw;
+    auto i=new_index;
+    auto j=new_index;
+    auto l=new_index;
+    tensor<int,rank<1>> one(1);
+    one[0] = 1;
+    tensor<int,rank<2>> t1(2001,999);
+    tensor<int,rank<1>> v(999), u(2001), tres(2001), tref(2001), tres2(999), tref2(999);
+    fill_values(t1, 0);
+    fill_values(v, 1);
+    fill_values(u, 2);
+
+    tres(i)=t1(i,j)*v(j);
+    tref(i)=t1(i,j)*v(j)*one(l)*one(l);
+    check_equal("Matrix-vector product 2001x999 * 999", tres, tref);
+
+    // vector on the left: the planner swaps the operands
+    tres2(j)=u(i)*t1(i,j);
+    tref2(j)=u(i)*t1(i,j)*one(l)*one(l);
+    check_equal("Vector-matrix product 2001 * 2001x999", tres2, tref2);
+}
+
+void check_write_only_evaluation(int nw = 1){
+    NW = nw;
+    auto i=new_index;
+    auto j=new_index;
+    auto l=new_index;
+    tensor<int,rank<1>> one(1);
+    one[0] = 1;
+
+    tensor<int,rank<1>> u(37), v(19);
+    tensor<int,rank<2>> tres(37,19), tref(37,19);
+    fill_values(u, 0);
+    fill_values(v, 3);
+    tres(i,j)=u(i)*v(j);
+    tref(i,j)=u(i)*v(j)*one(l)*one(l);
+    check_equal("Outer product 37 x 19", tres, tref);
+
+    // outputs of more than 16MB are written with streaming stores
+    tensor<int,rank<1>> u2(2049), v2(2051);
+    tensor<int,rank<2>> tres2(2049,2051), tref2(2049,2051);
+    fill_values(u2, 1);
+    fill_values(v2, 2);
+    tres2(i,j)=u2(i)*v2(j);
+    tref2(i,j)=u2(i)*v2(j)*one(l)*one(l);
+    check_equal("Streamed outer product 2049 x 2051", tres2, tref2);
+
+    tensor<int,rank<2>> t1(2051,2049), tres3(2049,2051), tref3(2049,2051);
+    fill_values(t1, 4);
+    tres3(i,j)=t1(j,i);
+    tref3(i,j)=t1(j,i)*one(l)*one(l);
+    check_equal("Streamed transposition 2051 x 2049", tres3, tref3);
+}
+
+// copies a fixed tensor into a dynamic one of rank 2, element by element
+template<class X> void copy_values(tensor<int,rank<2>>& t, X& f) {
+    auto iter=f.begin();
+    for(auto dest=t.begin(); dest!=t.end(); ++dest, ++iter) *dest = *iter;
+}
+
+template<size_t N, size_t M, size_t P>
+void check_fixed_product(const char* name){
+    auto i=new_index;
+    auto j=new_index;
+    auto k=new_index;
+    auto l=new_index;
+    tensor<int,rank<1>> one(1);
+    one[0] = 1;
+
+    tensor<int,fixed<N,M>> f1;
+    tensor<int,fixed<M,P>> f2;
+    tensor<int,fixed<N,P>> fres;
+    fill_values(f1, 0);
+    fill_values(f2, 5);
+    fres(i,j)=f1(i,k)*f2(k,j);
+
+    tensor<int,rank<2>> t1(N,M), t2(M,P), tref(N,P);
+    copy_values(t1, f1);
+    copy_values(t2, f2);
+    tref(i,j)=t1(i,k)*t2(k,j)*one(l)*one(l);
+    check_equal(name, fres, tref);
+}
+
+void check_fixed_multiplication(){
+    // the first nest is unrolled, the second exceeds the unroll limit and runs as a loop
+    check_fixed_product<3,5,7>("Fixed multiplication 3x5 * 5x7");
+    check_fixed_product<33,35,31>("Fixed multiplication 33x35 * 35x31");
+}
+
 void test_multiplication(int nw = 1){
     set_workers_number(nw);
     auto start = std::chrono::steady_clock::now();
@@ -74,6 +251,70 @@ void test_long_data_multiplication(int nw = 1){
     std::cout << std::endl;
 }
 
+void test_batch_multiplication(int nw = 1){
+    set_workers_number(nw);
+    auto start = std::chrono::steady_clock::now();
+
+    auto b=new_index;
+    auto i=new_index;
+    auto j=new_index;
+    auto k=new_index;
+    tensor<int,rank<3>> t1(1000,4,3), t2(1000,3,4), tres(1000,4,4);
+
+    for(auto iter=t1.begin(); iter!=t1.end(); ++iter)
+        *iter = 1;
+    for(auto iter=t2.begin(); iter!=t2.end(); ++iter)
+        *iter = 1;
+
+    tres(b,i,j)=t1(b,i,k)*t2(b,k,j);
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    std::cout << "Elapsed time: " << std::chrono::duration<double, std::milli>(time).count() << " ms.\n";
+    std::cout << std::endl;
+}
+
+void test_matrix_vector_multiplication(int nw = 1){
+    set_workers_number(nw);
+    auto start = std::chrono::steady_clock::now();
+
+    auto i=new_index;
+    auto j=new_index;
+    tensor<int,rank<2>> t1(2000,1000);
+    tensor<int> v(1000), tres(2000);
+
+    for(auto iter=t1.begin(); iter!=t1.end(); ++iter)
+        *iter = 1;
+    for(auto iter=v.begin(); iter!=v.end(); ++iter)
+        *iter = 1;
+
+    tres(i)=t1(i,j)*v(j);
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    std::cout << "Elapsed time: " << std::chrono::duration<double, std::milli>(time).count() << " ms.\n";
+    std::cout << std::endl;
+}
+
+void test_fixed_multiplication(){
+    auto start = std::chrono::steady_clock::now();
+
+    auto i=new_index;
+    auto j=new_index;
+    auto k=new_index;
+    tensor<int,fixed<2,3>> t23;
+    tensor<int,fixed<3,2>> t32;
+    tensor<int,fixed<2,2>> tres;
+
+    int count = 0;
+    for(auto iter=t23.begin(); iter!=t23.end(); ++iter)
+        *iter = count++;
+    count=0;
+    for(auto iter=t32.begin(); iter!=t32.end(); ++iter)
+        *iter = count++;
+
+    for (int n = 0; n < 100000; ++n)
+        tres(i,j)=t23(i,k)*t32(k,j);
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    std::cout << "Elapsed time (100000 products): " << std::chrono::duration<double, std::milli>(time).count() << " ms.\n";
+    std::cout << std::endl;
+}
 
 void test_sum(int nw = 1){
     set_workers_number(nw);
@@ -141,6 +382,19 @@ void test_invert(int nw = 1){
 
 // Aggregation of tests per operation type
 
+void correctness_tests(){
+    std::cout << "Correctness tests: " << std::endl;
+    for (int i = 1; i <=3  ; i+=2) {
+        check_multiplication(i);
+        check_batch_multiplication(i);
+        check_strassen_multiplication(i);
+        check_matrix_vector_multiplication(i);
+        check_write_only_evaluation(i);
+    }
+    check_fixed_multiplication();
+    std::cout << "________________________________ " << std::endl;
+}
+
 void sum_tests(){
 //    // sum
 //    std::cout << "Sum test: " << std::endl;
@@ -170,6 +424,21 @@ void multiplication_tests(){
         sleep(1);
     }
     std::cout << "________________________________ " << std::endl;
+    std::cout << "Batch Multiplication test: " << std::endl;
+    for (int i = 1; i <=8  ; ++i) {
+        test_batch_multiplication(i);
+        sleep(1);
+    }
+    std::cout << "________________________________ " << std::endl;
+    std::cout << "Fixed-shape Multiplication test: " << std::endl;
+    test_fixed_multiplication();
+    std::cout << "________________________________ " << std::endl;
+    std::cout << "Matrix-Vector Multiplication test: " << std::endl;
+    for (int i = 1; i <=8  ; ++i) {
+        test_matrix_vector_multiplication(i);
+        sleep(1);
+    }
+    std::cout << "________________________________ " << std::endl;
 
 //    for (int i = 1; i <=8  ; ++i) {
 //        test_long_data_multiplication(i);
@@ -188,8 +457,9 @@ void inversion_tests(){
 }
 
 int main(){
+    correctness_tests();
 //    inversion_tests();
     sum_tests();
     multiplication_tests();
-    return 0;
+    return failures==0 ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,460 @@
+#ifndef CONTRACTION_H
+#define CONTRACTION_H
+
+#include<vector>
+#include<thread>
+#include<algorithm>
+#include<cstring>
+#include<type_traits>
+#if defined(__SSE2__)
+#include<emmintrin.h>
+#endif
+#include"storage.h"
+
+namespace Tensor {
+namespace reserved {
+
+// outputs larger than this many bytes do not fit the last level cache: they are written
+// with streaming stores so that they do not evict the operands being read
+constexpr size_t streaming_threshold = 1UL<<24;
+
+// element store which, when stream is set, bypasses the cache and skips the read-for-ownership
+// of the line. Only 4 and 8 byte trivially copyable types can be streamed, the others are stored normally
+template<typename T>
+inline void store(T* ptr, const T& value, bool stream) {
+#if defined(__SSE2__)
+    if constexpr (std::is_trivially_copyable<T>::value && sizeof(T)==4) {
+        if (stream) {
+            int bits;
+            std::memcpy(&bits, &value, 4);
+            _mm_stream_si32(reinterpret_cast<int*>(ptr), bits);
+            return;
+        }
+    }
+#if defined(__x86_64__)
+    if constexpr (std::is_trivially_copyable<T>::value && sizeof(T)==8) {
+        if (stream) {
+            long long bits;
+            std::memcpy(&bits, &value, 8);
+            _mm_stream_si64(reinterpret_cast<long long*>(ptr), bits);
+            return;
+        }
+    }
+#endif
+#endif
+    *ptr = value;
+}
+
+// streaming stores are weakly ordered: each thread that issued them must fence before
+// its results are read by others
+inline void store_fence() {
+#if defined(__SSE2__)
+    _mm_sfence();
+#endif
+}
+
+// runs f(worker, begin, end) over [0,n) split in nw contiguous chunks, one thread per chunk.
+// as in the generic nest, the first n%nw workers get one extra job
+template<class F>
+void parallel_for(size_t n, size_t nw, F f) {
+    if (nw>n) nw=n;
+    if (nw<=1) {
+        if (n!=0) f(size_t(0), size_t(0), n);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(nw-1);
+    size_t begin=0;
+    for (size_t w=0; w!=nw; ++w) {
+        size_t end = begin + n/nw + (w < n%nw ? 1 : 0);
+        // the calling thread takes the last chunk instead of idling on join
+        if (w==nw-1) f(w, begin, end);
+        else threads.emplace_back(f, w, begin, end);
+        begin=end;
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+
+// C = A*B on dense row-major n x n blocks with leading dimensions ldc, lda, ldb,
+// blocked over the contracted index and the columns so that a tile of B stays in cache
+template<typename T>
+void block_multiply(T* c, size_t ldc, const T* a, size_t lda, const T* b, size_t ldb, size_t n) {
+    constexpr size_t tile=64;
+    for (size_t i=0; i!=n; ++i) std::fill(c+i*ldc, c+i*ldc+n, T());
+    for (size_t kk=0; kk<n; kk+=tile) {
+        const size_t kend=std::min(n, kk+tile);
+        for (size_t jj=0; jj<n; jj+=tile) {
+            const size_t jend=std::min(n, jj+tile);
+            for (size_t i=0; i!=n; ++i) {
+                T* ci=c+i*ldc;
+                for (size_t k=kk; k!=kend; ++k) {
+                    const T aik=a[i*lda+k];
+                    const T* bk=b+k*ldb;
+                    for (size_t j=jj; j!=jend; ++j) ci[j] += aik*bk[j];
+                }
+            }
+        }
+    }
+}
+
+// y += alpha*x on n contiguous elements. aligned tells that both start on an alignment boundary,
+// letting the compiler use aligned vector loads and stores without peeling
+template<typename T>
+inline void scaled_add(T* y, const T* x, T alpha, size_t n, bool aligned) {
+#if defined(__GNUC__)
+    if (aligned) {
+        T* ya=static_cast<T*>(__builtin_assume_aligned(y, alignment));
+        const T* xa=static_cast<const T*>(__builtin_assume_aligned(x, alignment));
+        for (size_t j=0; j!=n; ++j) ya[j] += alpha*xa[j];
+        return;
+    }
+#endif
+    for (size_t j=0; j!=n; ++j) y[j] += alpha*x[j];
+}
+
+// c = a + b, or c = a - b, on dense n x n blocks
+template<typename T>
+void block_add(T* c, size_t ldc, const T* a, size_t lda, const T* b, size_t ldb, size_t n, bool subtract=false) {
+    for (size_t i=0; i!=n; ++i) {
+        T* ci=c+i*ldc;
+        const T *ai=a+i*lda, *bi=b+i*ldb;
+        if (subtract) for (size_t j=0; j!=n; ++j) ci[j]=ai[j]-bi[j];
+        else for (size_t j=0; j!=n; ++j) ci[j]=ai[j]+bi[j];
+    }
+}
+
+// Strassen-Winograd product (7 multiplications, 15 additions) of n x n blocks, n a power of two
+// times a size not larger than threshold, at which it falls back to block_multiply.
+// The seven sub-multiplications are independent and run as tasks over the nw workers
+template<typename T>
+void strassen(T* c, size_t ldc, const T* a, size_t lda, const T* b, size_t ldb, size_t n, size_t threshold, size_t nw) {
+    if (n<=threshold) {
+        block_multiply(c, ldc, a, lda, b, ldb, n);
+        return;
+    }
+    const size_t h=n/2, hh=h*h;
+    const T *a11=a, *a12=a+h, *a21=a+h*lda, *a22=a21+h;
+    const T *b11=b, *b12=b+h, *b21=b+h*ldb, *b22=b21+h;
+    T *c11=c, *c12=c+h, *c21=c+h*ldc, *c22=c21+h;
+
+    // all temporaries are h x h with leading dimension h, taken from the scratch of this task
+    scratch buffer;
+    T *s1=buffer.get<T>(15*hh), *s2=s1+hh, *s3=s2+hh, *s4=s3+hh;
+    T *t1=s4+hh, *t2=t1+hh, *t3=t2+hh, *t4=t3+hh;
+    T *m1=t4+hh, *m2=m1+hh, *m3=m2+hh, *m4=m3+hh, *m5=m4+hh, *m6=m5+hh, *m7=m6+hh;
+
+    block_add(s1, h, a21, lda, a22, lda, h);
+    block_add(s2, h, s1, h, a11, lda, h, true);
+    block_add(s3, h, a11, lda, a21, lda, h, true);
+    block_add(s4, h, a12, lda, s2, h, h, true);
+    block_add(t1, h, b12, ldb, b11, ldb, h, true);
+    block_add(t2, h, b22, ldb, t1, h, h, true);
+    block_add(t3, h, b22, ldb, b12, ldb, h, true);
+    block_add(t4, h, t2, h, b21, ldb, h, true);
+
+    struct product { T* m; const T* a; size_t lda; const T* b; size_t ldb; };
+    const product products[7] = {
+        {m1, a11, lda, b11, ldb}, {m2, a12, lda, b21, ldb}, {m3, s4, h, b22, ldb}, {m4, a22, lda, t4, h},
+        {m5, s1, h, t1, h}, {m6, s2, h, t2, h}, {m7, s3, h, t3, h}
+    };
+    const size_t sub_nw = std::max<size_t>(1, nw/7);
+    parallel_for(7, nw, [&](size_t, size_t begin, size_t end) {
+        for (size_t p=begin; p!=end; ++p)
+            strassen(products[p].m, h, products[p].a, products[p].lda, products[p].b, products[p].ldb, h, threshold, sub_nw);
+    });
+
+    block_add(c11, ldc, m1, h, m2, h, h);
+    block_add(m6, h, m1, h, m6, h, h);      // u2 = m1+m6
+    block_add(m7, h, m6, h, m7, h, h);      // u3 = u2+m7
+    block_add(m6, h, m6, h, m5, h, h);      // u4 = u2+m5
+    block_add(c12, ldc, m6, h, m3, h, h);
+    block_add(c21, ldc, m7, h, m4, h, h, true);
+    block_add(c22, ldc, m7, h, m5, h, h);
+}
+
+
+// one loop of a binary contraction C = A*B: its width and the stride it has in
+// the destination (0), left (1) and right (2) operand. stride 0 means the index is absent there
+struct contraction_mode {
+    size_t width;
+    size_t stride[3];
+};
+
+// loops playing the same role in the contraction (batch, rows, columns or contracted indices).
+// modes that are contiguous in every operand are merged, so that the usual single-mode
+// group can be walked with a constant stride. The modes and offset tables of a group are
+// allocated from the memory resource of its plan
+struct contraction_group {
+    explicit contraction_group(std::pmr::memory_resource* resource) : modes(resource) {}
+
+    std::pmr::vector<contraction_mode> modes;
+
+    size_t count() const {
+        size_t result=1;
+        for (auto& m : modes) result *= m.width;
+        return result;
+    }
+    bool single() const { return modes.size()==1; }
+    size_t stride(int op) const { return modes.back().stride[op]; }
+    size_t width() const { return modes.back().width; }
+
+    // sorts the modes outer to inner according to operand op and merges the contiguous ones.
+    // empty groups become a single mode of width 1 so kernels never special-case them
+    void normalize(int op) {
+        std::sort(modes.begin(), modes.end(), [op](const contraction_mode& a, const contraction_mode& b) {
+            return a.stride[op] > b.stride[op];
+        });
+        std::pmr::vector<contraction_mode> merged(modes.get_allocator());
+        for (auto& m : modes) {
+            if (!merged.empty()) {
+                contraction_mode& outer = merged.back();
+                bool contiguous=true;
+                for (int i=0; i!=3; ++i) contiguous = contiguous && outer.stride[i]==m.stride[i]*m.width;
+                if (contiguous) {
+                    outer.width *= m.width;
+                    for (int i=0; i!=3; ++i) outer.stride[i]=m.stride[i];
+                    continue;
+                }
+            }
+            merged.push_back(m);
+        }
+        if (merged.empty()) merged.push_back({1,{0,0,0}});
+        modes.swap(merged);
+    }
+
+    // offsets of all the elements of the group in operand op, row-major over the modes
+    std::pmr::vector<size_t> offsets(int op) const {
+        std::pmr::vector<size_t> result(1,0,modes.get_allocator());
+        for (auto& m : modes) {
+            std::pmr::vector<size_t> next(modes.get_allocator());
+            next.reserve(result.size()*m.width);
+            for (size_t o : result)
+                for (size_t w=0; w!=m.width; ++w) next.push_back(o + w*m.stride[op]);
+            result.swap(next);
+        }
+        return result;
+    }
+};
+
+
+// the contraction C(b,i,j) = sum_k A(b,i,k)*B(b,k,j) where each of b,i,j,k stands for a
+// (possibly empty) group of indices. Any binary product of two tensors whose indices all
+// fall in one of these roles can be evaluated here instead of going through the generic nest.
+// All the bookkeeping of the plan comes from resource, the scratch arena of the evaluation
+struct contraction_plan {
+    enum { DEST=0, LHS=1, RHS=2 };
+
+    // below this many multiply-adds spawning threads costs more than it saves
+    static constexpr size_t min_parallel_work = 1UL<<15;
+
+    template<class MODES>
+    contraction_plan(const MODES& all, std::pmr::memory_resource* resource)
+            : batch(resource), rows(resource), cols(resource), red(resource), valid(true), swapped(false) {
+        for (auto& m : all) {
+            bool c=m.stride[DEST]!=0, a=m.stride[LHS]!=0, b=m.stride[RHS]!=0;
+            if (c && a && b) batch.modes.push_back(m);
+            else if (c && a) rows.modes.push_back(m);
+            else if (c && b) cols.modes.push_back(m);
+            else if (a && b) red.modes.push_back(m);
+            else if (m.width!=1) valid=false; // reductions over a single operand are left to the generic nest
+        }
+        // v(k)*A(k,j) is the same matrix-vector product as A(k,j)*v(k): keep the vector on the right
+        if (rows.modes.empty() && !cols.modes.empty()) {
+            swapped=true;
+            std::swap(rows, cols);
+            for (auto g : {&batch, &rows, &cols, &red})
+                for (auto& m : g->modes) std::swap(m.stride[LHS], m.stride[RHS]);
+        }
+        batch.normalize(DEST);
+        rows.normalize(DEST);
+        cols.normalize(DEST);
+        red.normalize(LHS);
+        // the inner kernel walks columns and contracted indices with a constant stride
+        valid = valid && cols.single() && red.single();
+    }
+
+    size_t work() const { return batch.count()*rows.count()*cols.count()*red.count(); }
+
+    // large square matrix products A(i,k)*B(k,j) can go through Strassen-Winograd
+    bool square(size_t threshold) const {
+        return batch.count()==1 && rows.single() && rows.width()>threshold &&
+               rows.width()==cols.width() && rows.width()==red.width();
+    }
+
+    // strassen_threshold is 0 when Strassen-Winograd is disabled
+    template<typename T>
+    void run(T* c, const T* a, const T* b, size_t nw, size_t strassen_threshold=0) const {
+        if (swapped) std::swap(a,b);
+        if (strassen_threshold!=0 && square(strassen_threshold)) {
+            run_strassen(c, a, b, nw, strassen_threshold);
+            return;
+        }
+        const std::pmr::vector<size_t> cb=batch.offsets(DEST), ab=batch.offsets(LHS), bb=batch.offsets(RHS);
+        const std::pmr::vector<size_t> cr=rows.offsets(DEST), ar=rows.offsets(LHS);
+        const size_t nbatch=cb.size(), nrows=cr.size();
+        if (work() < min_parallel_work) nw=1;
+
+        // outer products write every element once and only they can stream their (large) output
+        const bool outer = red.count()==1 && cols.count()!=1;
+        const bool stream = outer && cols.stride(DEST)==1 && nbatch*nrows*cols.count()*sizeof(T)>=streaming_threshold;
+
+        // matrix-vector products are memory bound and get their own kernel
+        auto kernel = [&](size_t n, size_t first, size_t last) {
+            if (outer) outer_kernel(c+cb[n], a+ab[n], b+bb[n], &cr[0], &ar[0], first, last, stream);
+            else if (cols.count()==1) vector_kernel(c+cb[n], a+ab[n], b+bb[n], &cr[0], &ar[0], first, last);
+            else matrix_kernel(c+cb[n], a+ab[n], b+bb[n], &cr[0], &ar[0], first, last);
+        };
+
+        if (nbatch>=nw) {
+            // enough independent problems: each worker takes whole batch items,
+            // keeping the right operand of an item in its own cache
+            parallel_for(nbatch, nw, [&](size_t, size_t begin, size_t end) {
+                for (size_t n=begin; n!=end; ++n) kernel(n, 0, nrows);
+                if (stream) store_fence();
+            });
+        } else {
+            // few large problems: split the rows of every matrix across the workers
+            parallel_for(nbatch*nrows, nw, [&](size_t, size_t begin, size_t end) {
+                while (begin!=end) {
+                    size_t n=begin/nrows, first=begin%nrows;
+                    size_t last=std::min(nrows, first+(end-begin));
+                    kernel(n, first, last);
+                    begin += last-first;
+                }
+                if (stream) store_fence();
+            });
+        }
+    }
+
+    // pads the operands to n = base*2^depth with base not larger than the threshold, so that every
+    // level of the recursion splits evenly, and copies the result back into the strided destination
+    template<typename T>
+    void run_strassen(T* c, const T* a, const T* b, size_t nw, size_t threshold) const {
+        const size_t n=rows.width();
+        size_t base=n, depth=0;
+        while (base>threshold) {
+            base=(base+1)/2;
+            ++depth;
+        }
+        const size_t m=base<<depth;
+
+        const size_t ci=rows.stride(DEST), cj=cols.stride(DEST);
+        const size_t ai=rows.stride(LHS), ak=red.stride(LHS);
+        const size_t bk=red.stride(RHS), bj=cols.stride(RHS);
+        scratch buffer;
+        T *pa=buffer.get<T>(m*m), *pb=buffer.get<T>(m*m), *pc=buffer.get<T>(m*m);
+        std::fill(pa, pa+m*m, T());
+        std::fill(pb, pb+m*m, T());
+        for (size_t i=0; i!=n; ++i)
+            for (size_t j=0; j!=n; ++j) {
+                pa[i*m+j]=a[i*ai+j*ak];
+                pb[i*m+j]=b[i*bk+j*bj];
+            }
+
+        strassen(pc, m, pa, m, pb, m, m, threshold, nw);
+
+        for (size_t i=0; i!=n; ++i)
+            for (size_t j=0; j!=n; ++j) c[i*ci+j*cj]=pc[i*m+j];
+    }
+
+    // C = a*b with no contracted index (a(i)*b(j), A(b,i)*B(b,j)): each element is a single
+    // product, stored once without clearing or reading back the destination
+    template<typename T>
+    void outer_kernel(T* c, const T* a, const T* b, const size_t* crow, const size_t* arow, size_t first, size_t last, bool stream) const {
+        const size_t ncols=cols.width();
+        const size_t cj=cols.stride(DEST), bj=cols.stride(RHS);
+        for (size_t i=first; i!=last; ++i) {
+            T* ci=c+crow[i];
+            const T ai=a[arow[i]];
+            for (size_t j=0; j!=ncols; ++j) store(ci+j*cj, T(ai*b[j*bj]), stream);
+        }
+    }
+
+    // plain C = A*B on a single batch item for rows [first,last).
+    // rows are reached through offset tables, columns and contracted index through strides
+    template<typename T>
+    void matrix_kernel(T* c, const T* a, const T* b, const size_t* crow, const size_t* arow, size_t first, size_t last) const {
+        const size_t ncols=cols.width(), nred=red.width();
+        const size_t cj=cols.stride(DEST), bj=cols.stride(RHS);
+        const size_t ak=red.stride(LHS), bk=red.stride(RHS);
+
+        if (cj==1 && bj==1) {
+            // unit-stride rows of B and C, as in plain and padded matrices: vector loads,
+            // aligned ones when the rows start on alignment boundaries
+            const bool b_aligned=is_aligned(b, bk);
+            for (size_t i=first; i!=last; ++i) {
+                T* ci=c+crow[i];
+                const T* ai=a+arow[i];
+                const bool aligned=b_aligned && is_aligned(static_cast<const void*>(ci));
+                std::fill(ci, ci+ncols, T());
+                for (size_t k=0; k!=nred; ++k) scaled_add(ci, b+k*bk, T(ai[k*ak]), ncols, aligned);
+            }
+        } else if (bj<=bk) {
+            // rows of B are contiguous: accumulate scaled rows of B into the row of C
+            for (size_t i=first; i!=last; ++i) {
+                T* ci=c+crow[i];
+                const T* ai=a+arow[i];
+                for (size_t j=0; j!=ncols; ++j) ci[j*cj]=T();
+                for (size_t k=0; k!=nred; ++k) {
+                    const T aik=ai[k*ak];
+                    const T* bk_row=b+k*bk;
+                    for (size_t j=0; j!=ncols; ++j) ci[j*cj] += aik*bk_row[j*bj];
+                }
+            }
+        } else {
+            // columns of B are contiguous: dot products along the contracted index
+            for (size_t i=first; i!=last; ++i) {
+                T* ci=c+crow[i];
+                const T* ai=a+arow[i];
+                for (size_t j=0; j!=ncols; ++j) {
+                    const T* bj_col=b+j*bj;
+                    T sum=T();
+                    for (size_t k=0; k!=nred; ++k) sum += ai[k*ak]*bj_col[k*bk];
+                    ci[j*cj]=sum;
+                }
+            }
+        }
+    }
+
+    // y = M*v on a single batch item for rows [first,last), where the rows of y and M can span
+    // several modes of the tensor (T(i,j,k)*v(k)) and v can contract any mode of M.
+    // M is read exactly once and always along its smallest stride
+    template<typename T>
+    void vector_kernel(T* c, const T* a, const T* b, const size_t* crow, const size_t* arow, size_t first, size_t last) const {
+        const size_t nred=red.width();
+        const size_t ak=red.stride(LHS), bk=red.stride(RHS);
+
+        if (rows.single() && rows.stride(LHS)<ak) {
+            // M is laid out along the rows (e.g. A(k,i)*v(k)): stream its rows one after the
+            // other, adding each scaled by v(k) to this worker's slab of y
+            const size_t ci=rows.stride(DEST), ai=rows.stride(LHS), n=last-first;
+            T* y=c+first*ci;
+            const T* m=a+first*ai;
+            for (size_t i=0; i!=n; ++i) y[i*ci]=T();
+            for (size_t k=0; k!=nred; ++k) {
+                const T vk=b[k*bk];
+                const T* mk=m+k*ak;
+                for (size_t i=0; i!=n; ++i) y[i*ci] += vk*mk[i*ai];
+            }
+        } else {
+            // M is laid out along the contracted index: one dot product per row
+            for (size_t i=first; i!=last; ++i) {
+                const T* mi=a+arow[i];
+                T sum=T();
+                for (size_t k=0; k!=nred; ++k) sum += mi[k*ak]*b[k*bk];
+                c[crow[i]]=sum;
+            }
+        }
+    }
+
+    contraction_group batch, rows, cols, red;
+    bool valid;
+    // operands exchanged so that the vector of a matrix-vector product is always on the right
+    bool swapped;
+};
+
+}
+};
+
+#endif // CONTRACTION_H
@@ -2,6 +2,8 @@
 #define EINSTEIN
 #include<map>
 #include <thread>
+#include<utility>
+#include"contraction.h"
 
 namespace Tensor {
 /*
@@ -24,6 +26,17 @@ void set_workers_number(size_t num_workers = 1){
     }
 }
 
+// Strassen-Winograd evaluation of large square matrix products. It rounds differently from the
+// plain product, so it is only used once enabled. Products are split recursively down to
+// threshold x threshold blocks, which are multiplied directly
+bool STRASSEN = false;
+size_t STRASSEN_THRESHOLD = 512;
+
+void set_strassen(bool enable, size_t threshold = 512){
+    STRASSEN = enable;
+    STRASSEN_THRESHOLD = threshold > 0 ? threshold : 1;
+}
+
 
 //struct holding dynamic info about index (using an unsigned to guarantee as many indices as we want)
 struct Index {
@@ -107,6 +120,14 @@ template<unsigned head, unsigned... tail> struct non_repeat<Index_Set<head, tail
 
 
 
+//metaprogramming trait to remove the repetitions from an Index_Set, keeping the first occurrence
+template<class T> struct unique;
+template<> struct unique<Index_Set<>> { typedef Index_Set<> type; };
+template<unsigned head, unsigned... tail> struct unique<Index_Set<head, tail...>> {
+    typedef typename append<head, typename unique<typename remove_all<head,Index_Set<tail...>>::type>::type>::type type;
+};
+
+
 //metaprogramming tool to count the number of ids in an Index_Set
 template<class T> struct index_count;
 template<unsigned... ids> struct index_count<Index_Set<ids...>> { static constexpr unsigned value = sizeof...(ids); };
@@ -120,6 +141,16 @@ template<unsigned head, unsigned...tail, class U> struct is_same_nonrepeat<Index
     static constexpr bool value = find<head,U>::value && is_same_nonrepeat<Index_Set<tail...>,typename remove_all<head,U>::type>::value;
 };
 
+namespace reserved {
+//metaprogramming trait returning the policy (dynamic, rank<R>) of a tensor type
+template<class T> struct tensor_policy;
+template<typename T, class P> struct tensor_policy<tensor<T,P>> { typedef P type; };
+
+//sizes the width container of a tensor: dynamic shapes grow, ranked ones are already sized
+inline void resize(std::vector<size_t>& widths, size_t count) { widths.resize(count); }
+template<size_t N> void resize(shape<N>& widths, size_t count) { widths.resize(count); }
+template<size_t R> void resize(std::array<size_t,R>&, size_t count) { assert(count==R); }
+}
 
 
 
@@ -137,6 +168,7 @@ template<class T, class U> struct einstein_addition;
 template<class T, class U> struct einstein_subtraction;
 
 template<typename T, class IDX, class type=einstein_proxy> class einstein_expression;
+template<typename T, class IDX, class E> class ranked_conversion;
 
 
 struct index_data {
@@ -162,6 +194,17 @@ public:
         std::map<Index,index_data>& x_index_map=x.get_index_map();
         assert(repeated_num==0);
 
+        // binary products matching the (batched) matrix multiplication pattern skip the generic nest
+        if (contract(x)) return *this;
+
+        // without repeated indices there is nothing to accumulate
+        bool write_only=true;
+        for (auto i=x_index_map.begin(); i!=x_index_map.end(); ++i) write_only = write_only && !(i->second.repeated);
+        if (write_only) {
+            assign(x);
+            return *this;
+        }
+
         // set all entries of dest tensor to 0
         setup();
         while(!end()) {
@@ -173,8 +216,8 @@ public:
         for (auto i=x_index_map.begin(); i!=x_index_map.end(); ++i) {
             auto j=index_map.find(i->first);
             if (i->second.repeated) {
-                assert(j==index_map.end());
-                add_index(i->first, i->second.width);
+                // repeated indices also present in the lvalue are batch indices: they are not summed
+                if (j==index_map.end()) add_index(i->first, i->second.width);
             } else {
                 assert(j!=index_map.end());
             }
@@ -190,107 +233,148 @@ public:
                 x.next();
             }
         }else{
-            std::vector<std::thread> threads(NW);
-            threads.reserve(NW);
-            std::vector<std::vector<size_t>> job_idxs = std::vector<std::vector<size_t>>(NW);
+            // the workers split the elements of the destination and each one sums over all the
+            // repeated indices of its own elements, so that no two workers add into the same element
+            std::vector<size_t> free, summed;
+            for (size_t a=0; a!=widths.size(); ++a) (strides[a]!=0 ? free : summed).push_back(a);
+            size_t count=1;
+            for (auto f=free.begin(); f!=free.end(); ++f) count *= widths[*f];
+
+            reserved::parallel_for(count, NW, [this, &x, &free, &summed](size_t, size_t begin, size_t end) {
+                std::vector<size_t> idxs(widths.size(), 0);
+                for (size_t n=begin; n!=end; ++n) {
+                    for (size_t pos=n, f=free.size(); f!=0; --f) {
+                        idxs[free[f-1]] = pos % widths[free[f-1]];
+                        pos /= widths[free[f-1]];
+                    }
+                    T sum=T();
+                    size_t s;
+                    do {
+                        sum += x.eval(idxs);
+                        for (s=summed.size(); s!=0 && ++idxs[summed[s-1]]==widths[summed[s-1]]; --s)
+                            idxs[summed[s-1]] = 0;
+                    } while (s!=0);
+                    eval(idxs) += sum;
+                }
+            });
+        }
+        
 
-            size_t job_count = 1;
-            for(auto w = widths.begin(); w != widths.end(); ++w){
-                job_count *= (*w);
-            }
+        return *this;
+    }
 
-            std::vector<int> jobs =  std::vector<int>(NW, job_count / NW); // jobs vector holds the queue of jobs for each worker thread
+    //conversion to a dynamic tensor computes the widths, creates the tensor and then uses operator = to fill it.
+    operator tensor<T,dynamic> () {
+        return convert<tensor<T,dynamic>>(*this);
+    }
 
-            size_t extrajob = job_count % NW; // if the modulo division is not 0 it means that some workers will have more jobs in their queue
+    template<typename T2, class type2> friend class tensor;
+    template<typename T2, class IDX2, class type2> friend class einstein_expression;
+    template<typename T2, class IDX2, class E2> friend class ranked_conversion;
 
-            while(extrajob > 0){  // distribute the remaining jobs to workers: for example if 5 jobs are left add them to the queue of workers 4, 3, 2, 1, 0 respectively
-                ++jobs[extrajob - 1];
-                --extrajob;
-            }
+protected:
 
-            int tpos = 0, cpos = 0; // cpos allows to maintain current tensor position for the thread
-            for(int i = 0; i < NW; ++i){
-                job_idxs.at(i) = std::vector<size_t>(widths.size());
-                cpos = tpos;
+    einstein_expression(T*ptr) :  repeated_num(0), start_ptr(ptr) {}
 
-                // compute tensor position for each thread and job
+    // evaluation of expressions without repeated indices (x(i,j)+y(i,j), transpositions). Every
+    // element of the destination is written exactly once, so it is neither cleared beforehand nor
+    // read back. Large outputs walked contiguously are written with streaming stores
+    template<class T2, class TYPE2>
+    void assign(einstein_expression<T2,dynamic,TYPE2>& x) {
+        setup();
+        x.setup();
+        size_t count=1;
+        for (auto w=widths.begin(); w!=widths.end(); ++w) count *= *w;
+        const bool stream = strides.back()==1 && count*sizeof(T)>=reserved::streaming_threshold;
 
-                for(int j = widths.size()-1; j >= 0; --j){
-                    job_idxs.at(i).at(j) = tpos % widths.at(j);
-                    tpos = tpos / widths.at(j);
-                }
-                tpos = cpos + jobs[i];
-//              std::cout << "Thread " << i << " process tensor position form  " << cpos << " to " <<  tpos << std::endl;
+        if(NW==1){
+            while(!end()) {
+                reserved::store(&eval(), T(x.eval()), stream);
+                next();
+                x.next();
             }
-
-            for(int i = 0; i < NW; ++i) {
-                // iterate through tensor positions to accomplish current job
-                threads.at(i) = std::thread([this, &x](int nj, std::vector<size_t> idxs) {
-                    for (int k = 0; k < nj; ++k) {
-                        eval(idxs) += x.eval(idxs);
-                        unsigned index = idxs.size() - 1;
+            if (stream) reserved::store_fence();
+        }else{
+            reserved::parallel_for(count, NW, [this, &x, stream](size_t, size_t begin, size_t end) {
+                // compute the tensor position of the first job of the thread
+                std::vector<size_t> idxs(widths.size());
+                for (size_t pos=begin, j=widths.size(); j!=0; --j) {
+                    idxs[j-1] = pos % widths[j-1];
+                    pos /= widths[j-1];
+                }
+                for (size_t n=begin; n!=end; ++n) {
+                    reserved::store(&eval(idxs), T(x.eval(idxs)), stream);
+                    unsigned index = idxs.size() - 1;
+                    ++idxs[index];
+                    while (idxs[index] == widths[index] && index > 0) {
+                        idxs[index] = 0;
+                        --index;
                         ++idxs[index];
-                        // check bounds
-                        while (idxs[index] == widths[index] && index > 0) {
-                            idxs[index] = 0;
-                            --index;
-                            ++idxs[index];
-                        }
                     }
+                }
+                if (stream) reserved::store_fence();
+            });
+        }
+    }
 
-                }, jobs[i], job_idxs[i]);
-            }
-
-            for(auto & thread : threads){
-                thread.join();
-            }
+    // generic expressions have no specialized kernel
+    template<class E>
+    bool contract(E&) { return false; }
+
+    // product of two tensors: collect the stride of every index in the destination and in both
+    // operands and let the contraction planner evaluate it if all indices fit a GEMM role
+    bool contract(einstein_expression<T,dynamic,einstein_multiplication<einstein_expression<T,dynamic,einstein_proxy>,einstein_expression<T,dynamic,einstein_proxy>>>& x) {
+        std::map<Index,index_data> &map1=x.exp1.get_index_map();
+        std::map<Index,index_data> &map2=x.exp2.get_index_map();
+        // the plan is a temporary of this evaluation: it is built in a scratch arena, which the
+        // next evaluations reuse, rather than on the heap
+        reserved::scratch buffer;
+        std::pmr::vector<reserved::contraction_mode> modes(buffer.resource());
+        for (auto i=x.index_map.begin(); i!=x.index_map.end(); ++i) {
+            auto j=index_map.find(i->first);
+            assert(j!=index_map.end() || i->second.repeated);
+            size_t dest_stride = j==index_map.end() ? 0 : j->second.stride;
+            modes.push_back({i->second.width, {dest_stride, map1[i->first].stride, map2[i->first].stride}});
         }
-        
 
-        return *this;
+        reserved::contraction_plan plan(modes, buffer.resource());
+        if (!plan.valid) return false;
+        plan.run(start_ptr, x.exp1.start_ptr, x.exp2.start_ptr, NW, STRASSEN ? STRASSEN_THRESHOLD : 0);
+        return true;
     }
 
-    //conversion to a dynamic tensor computes the widths, creates the tensor and then uses operator = to fill it.
-    operator tensor<T,dynamic> () {
-        widths.clear();
+    std::map<Index,index_data>& get_index_map() { return index_map; }
+
+    // evaluates x into a new tensor, with one dimension per non-repeated index of x in index order.
+    // The shape is built directly in the width type of RESULT, so ranked results never go through
+    // a dynamic tensor
+    template<class RESULT, class E>
+    static RESULT convert(E& x) {
+        std::map<Index,index_data> &index_map=x.get_index_map();
+        typename reserved::tensor_policy<RESULT>::type::width_type widths{};
+        size_t count=0;
         for (auto i=index_map.begin(); i!=index_map.end(); ++i) {
-            if(!(i->second.repeated)) widths.push_back(i->second.width);
+            if(!(i->second.repeated)) ++count;
         }
-        strides.resize(widths.size());
-        strides[widths.size()-1]=1;
-        for (int i=widths.size()-1; i!=0; --i) {
-            strides[i-1]=strides[i]*widths[i];
+        reserved::resize(widths,count);
+        count=0;
+        for (auto i=index_map.begin(); i!=index_map.end(); ++i) {
+            if(!(i->second.repeated)) widths[count++]=i->second.width;
         }
-        tensor<T,dynamic>  result(widths);
+        // the evaluation writes every element: no need to clear them first
+        RESULT result(reserved::uninitialized, widths);
         einstein_expression<T,dynamic> dest(result.start_ptr);
-        int count=0;
+        count=0;
         for (auto i=index_map.begin(); i!=index_map.end(); ++i ) {
             if(!(i->second.repeated)) {
-                assert(widths[count]==i->second.width);
-                dest.add_index(i->first,i->second.width,strides[count]);
+                dest.add_index(i->first,i->second.width,result.stride[count]);
                 ++count;
             }
         }
-
-        dest = std::move(*this);
-
+        dest = std::move(x);
         return result;
     }
 
-    template<size_t R>
-    operator tensor<T,rank<R>>() {
-        return operator tensor<T,dynamic> ();
-    }
-
-    template<typename T2, class type2> friend class tensor;
-    template<typename T2, class IDX2, class type2> friend class einstein_expression;
-
-protected:
-
-    einstein_expression(T*ptr) :  repeated_num(0), start_ptr(ptr) {}
-
-    std::map<Index,index_data>& get_index_map() { return index_map; }
-
     void setup() {
         widths.clear();
         strides.clear();
@@ -312,7 +396,7 @@ protected:
 
     T& eval() { return *current_ptr; }
 
-    T& eval(std::vector<size_t> idxs) {
+    T& eval(const std::vector<size_t>& idxs) {
         auto ptr = start_ptr;
 
         for(int i = idxs.size() - 1; i >= 0; --i){
@@ -407,18 +491,9 @@ public:
 
 
     operator tensor<T,dynamic> () {
-
-        std::pair<tensor<T,dynamic>,einstein_expression<T,dynamic>> result=prepare_conversion();
-
-        result.second = std::move(*this);
-
-        return result.first;
+        return einstein_expression<T,dynamic,einstein_proxy>::template convert<tensor<T,dynamic>>(*this);
     }
 
-    template<size_t R>
-    operator tensor<T,rank<R>>() {
-        return operator tensor<T,dynamic> ();
-    }
 
 
     template<typename T2, class IDX2, class type2> friend class einstein_expression;
@@ -459,36 +534,12 @@ protected:
 
     T eval() { return exp1.eval() * exp2.eval(); }
 
-    T eval(std::vector<size_t> idxs) {
+    T eval(const std::vector<size_t>& idxs) {
         return exp1.eval(idxs) * exp2.eval(idxs);
     }
 
     std::map<Index,index_data>& get_index_map() { return index_map; }
 
-    std::pair<tensor<T,dynamic>,einstein_expression<T,dynamic>> prepare_conversion() {
-        std::map<Index,index_data> &index_map=get_index_map();
-        std::vector<size_t> widths,strides;
-        for (auto i=index_map.begin(); i!=index_map.end(); ++i) {
-            if(!(i->second.repeated)) widths.push_back(i->second.width);
-        }
-        strides.resize(widths.size());
-        strides[widths.size()-1]=1;
-        for (int i=widths.size()-1; i!=0; --i) {
-            strides[i-1]=strides[i]*widths[i];
-        }
-        tensor<T,dynamic>  result(widths);
-        einstein_expression<T,dynamic> dest(result.start_ptr);
-        int count=0;
-        for (auto i=index_map.begin(); i!=index_map.end(); ++i ) {
-            if(!(i->second.repeated)) {
-                assert(widths[count]==i->second.width);
-                dest.add_index(i->first,i->second.width,strides[count]);
-                ++count;
-            }
-        }
-        return std::pair<tensor<T,dynamic>,einstein_expression<T,dynamic>>(result,dest);
-    }
-
 
     einstein_expression<T,dynamic,E1> exp1;
     einstein_expression<T,dynamic,E2> exp2;
@@ -581,30 +632,6 @@ protected:
 
     std::map<Index,index_data>& get_index_map() { return index_map; }
 
-    std::pair<tensor<T,dynamic>,einstein_expression<T,dynamic>> prepare_conversion() {
-        std::map<Index,index_data> &index_map=get_index_map();
-        std::vector<size_t> widths,strides;
-        for (auto i=index_map.begin(); i!=index_map.end(); ++i) {
-            if(!(i->second.repeated)) widths.push_back(i->second.width);
-        }
-        strides.resize(widths.size());
-        strides[widths.size()-1]=1;
-        for (int i=widths.size()-1; i!=0; --i) {
-            strides[i-1]=strides[i]*widths[i];
-        }
-        tensor<T,dynamic>  result(widths);
-        einstein_expression<T,dynamic> dest(result.start_ptr);
-        int count=0;
-        for (auto i=index_map.begin(); i!=index_map.end(); ++i ) {
-            if(!(i->second.repeated)) {
-                assert(widths[count]==i->second.width);
-                dest.add_index(i->first,i->second.width,strides[count]);
-                ++count;
-            }
-        }
-        return std::pair<tensor<T,dynamic>,einstein_expression<T,dynamic>>(result,dest);
-    }
-
 
     einstein_expression<T,dynamic,E1> exp1;
     einstein_expression<T,dynamic,E2> exp2;
@@ -621,16 +648,10 @@ template<typename T, class E1, class E2> class einstein_expression<T,dynamic,ein
     using einstein_expression<T,dynamic,einstein_binary<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::einstein_expression;
     using einstein_expression<T,dynamic,einstein_binary<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::exp1;
     using einstein_expression<T,dynamic,einstein_binary<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::exp2;
-    using einstein_expression<T,dynamic,einstein_binary<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::prepare_conversion;
 public:
 
     operator tensor<T,dynamic> () {
-
-        std::pair<tensor<T,dynamic>,einstein_expression<T,dynamic>> result=prepare_conversion();
-
-        result.second = std::move(*this);
-
-        return result.first;
+        return einstein_expression<T,dynamic,einstein_proxy>::template convert<tensor<T,dynamic>>(*this);
     }
 
     template<typename T2, class IDX2, class type2> friend class einstein_expression;
@@ -639,7 +660,7 @@ protected:
 
     T eval() { return exp1.eval() + exp2.eval(); }
 
-    T eval(std::vector<size_t> idxs) {
+    T eval(const std::vector<size_t>& idxs) {
         return exp1.eval(idxs) + exp2.eval(idxs);
     }
 };
@@ -650,16 +671,10 @@ template<typename T, class E1, class E2> class einstein_expression<T,dynamic,ein
     using einstein_expression<T,dynamic,einstein_binary<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::einstein_expression;
     using einstein_expression<T,dynamic,einstein_binary<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::exp1;
     using einstein_expression<T,dynamic,einstein_binary<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::exp2;
-    using einstein_expression<T,dynamic,einstein_binary<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::prepare_conversion;
 public:
 
     operator tensor<T,dynamic> () {
-
-        std::pair<tensor<T,dynamic>,einstein_expression<T,dynamic>> result=prepare_conversion();
-
-        result.second = std::move(*this);
-
-        return result.first;
+        return einstein_expression<T,dynamic,einstein_proxy>::template convert<tensor<T,dynamic>>(*this);
     }
 
     template<typename T2, class IDX2, class type2> friend class einstein_expression;
@@ -668,7 +683,7 @@ protected:
 
     T eval() { return exp1.eval() - exp2.eval(); }
 
-    T eval(std::vector<size_t> idxs) {
+    T eval(const std::vector<size_t>& idxs) {
         return exp1.eval(idxs) - exp2.eval(idxs);
     }
 };
@@ -680,8 +695,21 @@ protected:
  * they inherit from the base classes as the runtime behavior is the same: they are needed only to add comiletime behavior
  */
 
+// CRTP base providing the conversion of the static expressions E to ranked tensors: ranked results
+// take their rank from the free indices at compile time and are built directly
+template<typename T, class IDX, class E>
+class ranked_conversion {
+public:
+    template<size_t R>
+    operator tensor<T,rank<R>>() {
+        static_assert(index_count<typename non_repeat<IDX>::set>::value==R, "Rank of the tensor does not match the free indices of the Einstein expression");
+        return einstein_expression<T,dynamic,einstein_proxy>::template convert<tensor<T,rank<R>>>(static_cast<E&>(*this));
+    }
+};
+
 template<typename T, unsigned...ids>
-class einstein_expression<T,Index_Set<ids...>,einstein_proxy> : public einstein_expression<T,dynamic,einstein_proxy> {
+class einstein_expression<T,Index_Set<ids...>,einstein_proxy> : public einstein_expression<T,dynamic,einstein_proxy>,
+        public ranked_conversion<T,Index_Set<ids...>,einstein_expression<T,Index_Set<ids...>,einstein_proxy>> {
 public:
 
     using einstein_expression<T,dynamic,einstein_proxy>::einstein_expression;
@@ -689,7 +717,10 @@ public:
     template<class T2, class TYPE2, unsigned...ids2>
     einstein_expression<T,Index_Set<ids...>,einstein_proxy>& operator =(einstein_expression<T2,Index_Set<ids2...>,TYPE2>&& x) {
         static_assert(is_same_nonrepeat<Index_Set<ids...>,typename non_repeat<Index_Set<ids...>>::set>::value, "Repeated indices in lvalue Einstein expression");
-        static_assert(is_same_nonrepeat<Index_Set<ids...>, typename non_repeat<Index_Set<ids2...>>::set>::value, "Non-repeated indices in lvalue and rvalue Einstein expressions are not the same");
+        // every free index of the rvalue must appear in the lvalue. The lvalue may also name repeated
+        // indices of the rvalue: those are batch indices, shared by the operands but not summed
+        static_assert(index_count<typename set_diff<typename non_repeat<Index_Set<ids2...>>::set, Index_Set<ids...>>::type>::value==0, "Non-repeated indices of the rvalue Einstein expression missing from the lvalue");
+        static_assert(index_count<typename set_diff<Index_Set<ids...>, Index_Set<ids2...>>::type>::value==0, "Indices of the lvalue Einstein expression missing from the rvalue");
         einstein_expression<T,dynamic,einstein_proxy>::operator = (static_cast<einstein_expression<T2,dynamic,TYPE2>&&>(x));
         return *this;
     }
@@ -698,7 +729,8 @@ public:
 
 template<typename T, class E1, class E2, unsigned...idx>
 class einstein_expression<T,Index_Set<idx...>,einstein_multiplication<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>> :
-        public einstein_expression<T,dynamic,einstein_multiplication<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>> {
+        public einstein_expression<T,dynamic,einstein_multiplication<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>,
+        public ranked_conversion<T,Index_Set<idx...>,einstein_expression<T,Index_Set<idx...>,einstein_multiplication<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>> {
 public:
     using einstein_expression<T,dynamic,einstein_multiplication<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::einstein_expression;
 };
@@ -706,7 +738,8 @@ public:
 
 template<typename T, class E1, class E2, unsigned...idx>
 class einstein_expression<T,Index_Set<idx...>,einstein_addition<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>> :
-        public einstein_expression<T,dynamic,einstein_addition<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>> {
+        public einstein_expression<T,dynamic,einstein_addition<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>,
+        public ranked_conversion<T,Index_Set<idx...>,einstein_expression<T,Index_Set<idx...>,einstein_addition<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>> {
 public:
     using einstein_expression<T,dynamic,einstein_addition<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::einstein_expression;
 };
@@ -714,7 +747,8 @@ public:
 
 template<typename T, class E1, class E2, unsigned...idx>
 class einstein_expression<T,Index_Set<idx...>,einstein_subtraction<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>> :
-        public einstein_expression<T,dynamic,einstein_subtraction<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>> {
+        public einstein_expression<T,dynamic,einstein_subtraction<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>,
+        public ranked_conversion<T,Index_Set<idx...>,einstein_expression<T,Index_Set<idx...>,einstein_subtraction<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>> {
 public:
     using einstein_expression<T,dynamic,einstein_subtraction<einstein_expression<T,dynamic,E1>,einstein_expression<T,dynamic,E2>>>::einstein_expression;
 };
@@ -748,5 +782,212 @@ operator - (einstein_expression<T,IDX1,E1> &&e1, einstein_expression<T,IDX2,E2>
 };
 
 
+
+/* Einstein expressions over fixed-shape tensors
+ * all widths and strides are known at compile time, so the whole loop nest is resolved by the compiler:
+ * every element of the destination becomes a straight-line sum of products at constant offsets,
+ * with no index maps, no allocations and no threads. Meant for small tensors (3x3, 4x4, ...)
+ */
+
+template<typename T, class IDX, class SHAPE> class fixed_expression;
+template<class E1, class E2> class fixed_product;
+template<class E1, class E2, bool subtract> class fixed_sum;
+
+// CRTP base of all fixed-shape expressions, used to restrict the operators to them
+template<class E> struct fixed_einstein {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+namespace reserved {
+// loop nests of more iterations than this are not unrolled but run as a plain loop over the
+// iteration count, so that larger fixed shapes do not blow up compile time and code size
+constexpr size_t fixed_unroll_limit = 1024;
+
+// compile-time loop nest over the ids loops..., outer to inner, with widths taken from expression E
+template<class E, unsigned... loops> struct fixed_loops {
+    static constexpr unsigned id[] = {loops...};
+    static constexpr size_t width[] = {E::width(loops)...};
+    static constexpr size_t count = (E::width(loops) * ... * 1UL);
+
+    // value taken by index idx at the pos-th iteration of the nest
+    static constexpr size_t value(unsigned idx, size_t pos) {
+        size_t result=0;
+        for (size_t n=sizeof...(loops); n!=0; --n) {
+            if (id[n-1]==idx) result = pos%width[n-1];
+            pos /= width[n-1];
+        }
+        return result;
+    }
+};
+
+template<class E, class OUTER, class INNER> struct make_fixed_loops;
+template<class E, unsigned... outer, unsigned... inner> struct make_fixed_loops<E,Index_Set<outer...>,Index_Set<inner...>> {
+    typedef fixed_loops<E, outer..., inner...> type;
+};
+
+// checks that the indices shared by two expressions have the same width
+template<class E1, class E2, unsigned... ids>
+constexpr bool same_widths(Index_Set<ids...>) {
+    return ((E2::width(ids)==0 || E1::width(ids)==E2::width(ids)) && ... && true);
+}
+}
+
+
+// tensor with indices applied: the leaves of the expression, and the only valid lvalue
+template<typename T, unsigned... ids, size_t... D>
+class fixed_expression<T,Index_Set<ids...>,fixed<D...>> : public fixed_einstein<fixed_expression<T,Index_Set<ids...>,fixed<D...>>> {
+public:
+    typedef T value_type;
+    typedef Index_Set<ids...> index_set;
+
+    static constexpr size_t width(unsigned idx) {
+        for (size_t r=0; r!=sizeof...(ids); ++r) if (id[r]==idx) return dim[r];
+        return 0;
+    }
+
+    // offset of the element visited at the pos-th iteration of the nest. Repeated ids (traces)
+    // simply add up their strides
+    template<class NEST>
+    static constexpr size_t offset(size_t pos) {
+        size_t result=0;
+        for (size_t r=0; r!=sizeof...(ids); ++r) result += stride(r)*NEST::value(id[r],pos);
+        return result;
+    }
+
+    template<class NEST, size_t POS>
+    T eval() const {
+        constexpr size_t off=offset<NEST>(POS);
+        return ptr[off];
+    }
+    template<class NEST>
+    T eval(size_t pos) const { return ptr[offset<NEST>(pos)]; }
+
+    // assignment unrolls the loop nest: destination indices outside, summed indices inside
+    template<class E>
+    fixed_expression& operator =(const fixed_einstein<E>& x) {
+        typedef typename E::index_set rhs_set;
+        static_assert(is_same_nonrepeat<Index_Set<ids...>,typename non_repeat<Index_Set<ids...>>::set>::value, "Repeated indices in lvalue Einstein expression");
+        static_assert(index_count<typename set_diff<typename non_repeat<rhs_set>::set, Index_Set<ids...>>::type>::value==0, "Non-repeated indices of the rvalue Einstein expression missing from the lvalue");
+        static_assert(index_count<typename set_diff<Index_Set<ids...>, rhs_set>::type>::value==0, "Indices of the lvalue Einstein expression missing from the rvalue");
+        static_assert(((E::width(ids)==width(ids)) && ... && true), "Widths of lvalue and rvalue Einstein expressions do not match");
+
+        typedef typename set_diff<typename unique<rhs_set>::type, Index_Set<ids...>>::type summed;
+        typedef typename reserved::make_fixed_loops<E,Index_Set<ids...>,summed>::type nest;
+        constexpr size_t outputs = (D * ... * 1UL);
+        if constexpr (nest::count<=reserved::fixed_unroll_limit) {
+            assign<nest, nest::count/outputs>(x.self(), std::make_index_sequence<outputs>());
+        } else {
+            constexpr size_t sums = nest::count/outputs;
+            for (size_t o=0; o!=outputs; ++o) {
+                T result = T();
+                for (size_t s=0; s!=sums; ++s) result += x.self().template eval<nest>(o*sums+s);
+                ptr[offset<nest>(o*sums)] = result;
+            }
+        }
+        return *this;
+    }
+
+    fixed_expression(const fixed_expression&) = default;
+    fixed_expression& operator =(const fixed_expression& x) { return operator =<fixed_expression>(x); }
+
+    template<typename T2, class type2> friend class tensor;
+
+private:
+    explicit fixed_expression(T* p) : ptr(p) {}
+
+    static constexpr unsigned id[] = {ids...};
+    static constexpr size_t dim[] = {D...};
+    static constexpr size_t stride(size_t r) {
+        size_t result=1;
+        for (size_t n=r+1; n<sizeof...(D); ++n) result *= dim[n];
+        return result;
+    }
+
+    template<class NEST, size_t SUMS, class E, size_t... O>
+    void assign(const E& x, std::index_sequence<O...>) {
+        ((ptr[offset<NEST>(O*SUMS)] = sum<NEST,O*SUMS>(x, std::make_index_sequence<SUMS>())), ...);
+    }
+
+    template<class NEST, size_t FIRST, class E, size_t... S>
+    static T sum(const E& x, std::index_sequence<S...>) {
+        return (T() + ... + x.template eval<NEST,FIRST+S>());
+    }
+
+    T* ptr;
+};
+
+
+template<class E1, class E2>
+class fixed_product : public fixed_einstein<fixed_product<E1,E2>> {
+public:
+    typedef typename E1::value_type value_type;
+    typedef typename merge<typename E1::index_set, typename E2::index_set>::type index_set;
+    static_assert(reserved::same_widths<E1,E2>(typename E1::index_set()), "Width mismatch between repeated indices");
+
+    fixed_product(const E1& e1, const E2& e2) : exp1(e1), exp2(e2) {}
+
+    static constexpr size_t width(unsigned idx) { return E1::width(idx)!=0 ? E1::width(idx) : E2::width(idx); }
+
+    template<class NEST, size_t POS>
+    value_type eval() const { return exp1.template eval<NEST,POS>() * exp2.template eval<NEST,POS>(); }
+    template<class NEST>
+    value_type eval(size_t pos) const { return exp1.template eval<NEST>(pos) * exp2.template eval<NEST>(pos); }
+
+private:
+    E1 exp1;
+    E2 exp2;
+};
+
+
+// sums are evaluated in the same nest as the rest of the expression, so their operands can not have
+// indices of their own to sum over
+template<class E1, class E2, bool subtract>
+class fixed_sum : public fixed_einstein<fixed_sum<E1,E2,subtract>> {
+public:
+    typedef typename E1::value_type value_type;
+    typedef typename E1::index_set index_set;
+    static_assert(is_same_nonrepeat<typename E1::index_set,typename non_repeat<typename E1::index_set>::set>::value &&
+                  is_same_nonrepeat<typename E2::index_set,typename non_repeat<typename E2::index_set>::set>::value,
+                  "Repeated indices in the operands of a fixed-shape Einstein sum");
+    static_assert(is_same_nonrepeat<typename E1::index_set,typename E2::index_set>::value, "Operands of an Einstein sum have different indices");
+    static_assert(reserved::same_widths<E1,E2>(typename E1::index_set()), "Width mismatch between the operands of an Einstein sum");
+
+    fixed_sum(const E1& e1, const E2& e2) : exp1(e1), exp2(e2) {}
+
+    static constexpr size_t width(unsigned idx) { return E1::width(idx); }
+
+    template<class NEST, size_t POS>
+    value_type eval() const {
+        if (subtract) return exp1.template eval<NEST,POS>() - exp2.template eval<NEST,POS>();
+        return exp1.template eval<NEST,POS>() + exp2.template eval<NEST,POS>();
+    }
+    template<class NEST>
+    value_type eval(size_t pos) const {
+        if (subtract) return exp1.template eval<NEST>(pos) - exp2.template eval<NEST>(pos);
+        return exp1.template eval<NEST>(pos) + exp2.template eval<NEST>(pos);
+    }
+
+private:
+    E1 exp1;
+    E2 exp2;
+};
+
+
+template<class E1, class E2>
+fixed_product<E1,E2> operator * (const fixed_einstein<E1>& e1, const fixed_einstein<E2>& e2) {
+    return fixed_product<E1,E2>(e1.self(), e2.self());
+}
+
+template<class E1, class E2>
+fixed_sum<E1,E2,false> operator + (const fixed_einstein<E1>& e1, const fixed_einstein<E2>& e2) {
+    return fixed_sum<E1,E2,false>(e1.self(), e2.self());
+}
+
+template<class E1, class E2>
+fixed_sum<E1,E2,true> operator - (const fixed_einstein<E1>& e1, const fixed_einstein<E2>& e2) {
+    return fixed_sum<E1,E2,true>(e1.self(), e2.self());
+}
+
+
 };
 #endif // EINSTEIN
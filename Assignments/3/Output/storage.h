@@ -0,0 +1,603 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include<new>
+#include<memory>
+#include<memory_resource>
+#include<vector>
+#include<cassert>
+#include<mutex>
+#include<atomic>
+#include<cstdint>
+#include<algorithm>
+#include<type_traits>
+#include<iterator>
+#include<initializer_list>
+#include<cstring>
+#if defined(__linux__)
+#include<sys/mman.h>
+#include<fstream>
+#include<sstream>
+#include<string>
+#endif
+
+namespace Tensor {
+
+// leading-dimension padding of new dynamic and ranked tensors: rows (the innermost dimension)
+// start on an alignment boundary, and rows spanning a multiple of 4KB get one more line so that
+// the elements of a column do not all map to the same cache set. Off by default, as padded
+// tensors are no longer contiguous
+bool PADDING = false;
+
+void set_padding(bool enable = true){
+    PADDING = enable;
+}
+
+// huge pages for large tensors: heap blocks of at least threshold bytes are mapped on 2MB pages,
+// explicitly reserved ones (hugetlbfs) when available, transparent ones otherwise. Only tensors
+// allocating outside of a resource_scope are concerned. huge_page_bytes() tells what was obtained
+bool HUGE_PAGES = false;
+size_t HUGE_PAGE_THRESHOLD = 1UL<<26;
+
+void set_huge_pages(bool enable, size_t threshold = 1UL<<26){
+    HUGE_PAGES = enable;
+    HUGE_PAGE_THRESHOLD = threshold;
+}
+
+// bytes of the mapping holding ptr that are backed by huge pages (0 if unknown)
+size_t huge_page_bytes(const void* ptr){
+    size_t result=0;
+#if defined(__linux__)
+    std::ifstream smaps("/proc/self/smaps");
+    const std::uintptr_t address=reinterpret_cast<std::uintptr_t>(ptr);
+    bool inside=false;
+    std::string line;
+    while (std::getline(smaps, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key.find('-')!=std::string::npos && key.back()!=':') {
+            // header line of a mapping: start-end perms ...
+            if (inside) break;
+            const std::uintptr_t begin=std::stoull(key.substr(0, key.find('-')), nullptr, 16);
+            const std::uintptr_t end=std::stoull(key.substr(key.find('-')+1), nullptr, 16);
+            inside = begin<=address && address<end;
+        } else if (inside && (key=="AnonHugePages:" || key=="Private_Hugetlb:" || key=="Shared_Hugetlb:")) {
+            size_t kb=0;
+            fields >> kb;
+            result += kb*1024;
+        }
+    }
+#endif
+    return result;
+}
+
+namespace reserved {
+
+// alignment in bytes of heap storage: a cache line, and the widest x86 vector register
+constexpr size_t alignment = 64;
+
+inline bool is_aligned(const void* ptr) {
+    return reinterpret_cast<std::uintptr_t>(ptr)%alignment==0;
+}
+
+// rows of leading dimension ld starting at ptr are all aligned
+template<typename T>
+inline bool is_aligned(const T* ptr, size_t ld) {
+    return is_aligned(static_cast<const void*>(ptr)) && (ld*sizeof(T))%alignment==0;
+}
+
+// memory resource new tensors of this thread allocate from, nullptr for the default one
+inline std::pmr::memory_resource*& current_resource() {
+    static thread_local std::pmr::memory_resource* resource=nullptr;
+    return resource;
+}
+
+// stride of the rows of a new tensor whose innermost dimension has the given width.
+// rows shorter than a line are never padded, so that small tensors stay small
+template<typename T>
+size_t row_stride(size_t width) {
+    if (!PADDING || alignment%sizeof(T)!=0 || width*sizeof(T)<alignment) return width;
+    constexpr size_t line = alignment/sizeof(T);
+    size_t result = (width+line-1)/line*line;
+    if ((result*sizeof(T))%4096==0) result += line;
+    return result;
+}
+
+// right-major strides of a new tensor with the given widths, padded as set by set_padding.
+// returns the number of elements to allocate
+template<typename T, class W, class S>
+size_t layout(const W& width, S& stride) {
+    const size_t r=width.size();
+    stride[r-1]=1UL;
+    for (size_t i=r-1; i!=0; --i) stride[i-1] = i==r-1 ? row_stride<T>(width[i]) : stride[i]*width[i];
+    return stride[0]*width[0];
+}
+
+// tag of the internal construction paths, used when every element is written before the tensor
+// is exposed (evaluation results, bulk loads): elements of trivial types are left uninitialized
+struct uninitialized_t {};
+constexpr uninitialized_t uninitialized{};
+
+// tag of the borrowing construction paths of tensor views
+struct borrow_t {};
+constexpr borrow_t borrow{};
+
+constexpr size_t huge_page_size = 1UL<<21;
+
+inline size_t huge_page_round(size_t bytes) {
+    return (bytes+huge_page_size-1)/huge_page_size*huge_page_size;
+}
+
+// maps bytes on huge pages, or returns nullptr
+inline void* map_huge_pages(size_t bytes) {
+#if defined(__linux__)
+    const size_t size=huge_page_round(bytes);
+#if defined(MAP_HUGETLB)
+    void* ptr=mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+    if (ptr!=MAP_FAILED) return ptr;
+#endif
+    // no reserved huge pages: map one page more so that the block can start on a 2MB boundary,
+    // trim the excess and ask for transparent huge pages
+    char* raw=static_cast<char*>(mmap(nullptr, size+huge_page_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0));
+    if (raw==MAP_FAILED) return nullptr;
+    char* block=raw + (huge_page_size - reinterpret_cast<std::uintptr_t>(raw)%huge_page_size)%huge_page_size;
+    if (block!=raw) munmap(raw, block-raw);
+    if (block+size!=raw+size+huge_page_size) munmap(block+size, raw+size+huge_page_size-(block+size));
+#if defined(MADV_HUGEPAGE)
+    madvise(block, size, MADV_HUGEPAGE);
+#endif
+    return block;
+#else
+    return nullptr;
+#endif
+}
+
+inline void unmap_huge_pages(void* ptr, size_t bytes) {
+#if defined(__linux__)
+    munmap(ptr, huge_page_round(bytes));
+#endif
+}
+
+// header of a heap block, followed by the elements at the next alignment boundary. The reference
+// count lives in the same allocation as the elements, so a tensor costs a single allocation, and
+// the block records the resource it came from, so it is returned there whoever frees it
+struct block_header {
+    std::atomic<size_t> refs;
+    std::pmr::memory_resource* resource;
+    size_t count;
+    bool huge;
+};
+constexpr size_t header_bytes = alignment;
+static_assert(sizeof(block_header)<=header_bytes, "block header larger than its slot");
+
+// element storage of the dynamic and ranked tensors
+// tensors of at most small_bytes of trivial elements keep them inline, so tiny temporaries cost neither
+// heap allocations nor atomic reference counting. Inline elements are values, as in an std::array:
+// copies, and slices and windows of the tensor, get their own copy of them. Larger tensors allocate a
+// reference-counted heap block when they are created, from the memory resource current in the
+// allocating thread, and their copies, slices and windows share it without allocating.
+// A borrowed storage, see borrow(), refers to the elements of another storage without holding a
+// reference: it owns nothing and must not outlive its lender. Copies and moves of a borrowed storage
+// own the elements again. As for std::string, moving a small tensor moves its elements, so pointers,
+// iterators and views into it do not follow
+template<typename T>
+class storage {
+public:
+    static constexpr size_t small_bytes = 64;
+    static constexpr size_t small_size = std::is_trivial<T>::value ? small_bytes/sizeof(T) : 0;
+
+    storage() : block(nullptr), lender(nullptr) {}
+
+    // n value-initialized elements
+    explicit storage(size_t n) : block(n>small_size ? allocate(n) : nullptr), lender(nullptr) {
+        std::uninitialized_value_construct_n(begin(), n);
+    }
+
+    // n default-initialized elements: no pass over memory for trivial types
+    storage(size_t n, uninitialized_t) : block(n>small_size ? allocate(n) : nullptr), lender(nullptr) {
+        std::uninitialized_default_construct_n(begin(), n);
+    }
+
+    storage(const storage& s) : block(s.block), lender(nullptr) {
+        if (block) acquire();
+        else copy_small(s.source());
+    }
+    storage(storage&& s) : block(s.block), lender(nullptr) {
+        if (!block) copy_small(s.source());
+        else if (s.lender) acquire();
+        else s.block=nullptr;
+    }
+    storage& operator = (const storage& s) {
+        storage copy(s);
+        return *this = std::move(copy);
+    }
+    storage& operator = (storage&& s) {
+        storage moved(std::move(s));
+        release();
+        block=moved.block;
+        lender=nullptr;
+        if (block) moved.block=nullptr;
+        else copy_small(moved);
+        return *this;
+    }
+    ~storage() { release(); }
+
+    T* begin() const {
+        if (block) return reinterpret_cast<T*>(reinterpret_cast<char*>(block)+header_bytes);
+        if (lender) return lender->begin();
+        return reinterpret_cast<T*>(const_cast<unsigned char*>(small));
+    }
+
+    bool borrowed() const { return lender!=nullptr; }
+
+    // lets this storage borrow the elements of s, or of its lender, without touching their reference count
+    void borrow(const storage& s) {
+        release();
+        lender=&s.source();
+        block=lender->block;
+    }
+
+    // ptr, pointing into the elements of from, once they have been copied or moved to this storage.
+    // Heap elements stay in place, inline ones are at the same offset in this storage
+    T* rebase(const storage& from, T* ptr) const {
+        return block ? ptr : begin() + (ptr-from.begin());
+    }
+
+private:
+    // the storage owning the elements
+    const storage& source() const { return lender ? *lender : *this; }
+
+    void copy_small(const storage& s) {
+        if constexpr (small_size>0) std::memcpy(small, s.small, sizeof(small));
+    }
+
+    // heap block for n elements, with its header set and the elements left unconstructed
+    static block_header* allocate(size_t n) {
+        std::pmr::memory_resource* resource=current_resource();
+        const size_t bytes=header_bytes + n*sizeof(T);
+        void* ptr=nullptr;
+        bool huge=false;
+        if (HUGE_PAGES && resource==nullptr && n*sizeof(T)>=HUGE_PAGE_THRESHOLD) {
+            ptr=map_huge_pages(bytes);
+            huge = ptr!=nullptr;
+        }
+        if (resource==nullptr) resource=std::pmr::get_default_resource();
+        if (!huge) ptr=resource->allocate(bytes, alignment);
+        return new(ptr) block_header{{1}, resource, n, huge};
+    }
+
+    void acquire() {
+        if (block) block->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() {
+        if (lender || !block || block->refs.fetch_sub(1, std::memory_order_acq_rel)!=1) return;
+        const size_t bytes=header_bytes + block->count*sizeof(T);
+        std::destroy_n(begin(), block->count);
+        if (block->huge) unmap_huge_pages(block, bytes);
+        else block->resource->deallocate(block, bytes, alignment);
+    }
+
+    block_header* block;
+    const storage* lender;
+    alignas(T) unsigned char small[small_size>0 ? small_size*sizeof(T) : 1];
+};
+
+// shape of the dynamic tensors: a vector of sizes kept inline up to N entries, so creating, copying and
+// iterating over dynamic tensors of small rank does not allocate. Higher ranks spill to the heap.
+// Only the operations of std::vector the tensors use are provided, and insertion is at the end only
+template<size_t N>
+class shape {
+public:
+    typedef size_t value_type;
+    typedef size_t* iterator;
+    typedef const size_t* const_iterator;
+
+    shape() : count(0), capacity(N), ptr(local) {}
+    shape(size_t n, size_t value) : shape() { resize(n, value); }
+    template<class It, class = typename std::iterator_traits<It>::iterator_category>
+    shape(It first, It last) : shape() { insert(end(), first, last); }
+    shape(std::initializer_list<size_t> values) : shape(values.begin(), values.end()) {}
+
+    shape(const shape& s) : shape(s.begin(), s.end()) {}
+    shape(shape&& s) : shape() { *this = std::move(s); }
+    shape& operator = (const shape& s) {
+        if (this!=&s) {
+            count=0;
+            insert(end(), s.begin(), s.end());
+        }
+        return *this;
+    }
+    shape& operator = (shape&& s) {
+        if (s.ptr==s.local) return *this = static_cast<const shape&>(s);
+        if (ptr!=local) delete[] ptr;
+        ptr=s.ptr;
+        count=s.count;
+        capacity=s.capacity;
+        s.ptr=s.local;
+        s.count=0;
+        s.capacity=N;
+        return *this;
+    }
+    ~shape() { if (ptr!=local) delete[] ptr; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count==0; }
+
+    iterator begin() { return ptr; }
+    iterator end() { return ptr+count; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr+count; }
+
+    size_t& operator[](size_t i) { return ptr[i]; }
+    const size_t& operator[](size_t i) const { return ptr[i]; }
+
+    void clear() { count=0; }
+
+    void resize(size_t n, size_t value=0) {
+        reserve(n);
+        for (size_t i=count; i<n; ++i) ptr[i]=value;
+        count=n;
+    }
+
+    template<class It>
+    iterator insert(const_iterator pos, It first, It last) {
+        assert(pos==end());
+        const size_t n=std::distance(first, last);
+        reserve(count+n);
+        std::copy(first, last, ptr+count);
+        count += n;
+        return ptr+count-n;
+    }
+
+private:
+    void reserve(size_t n) {
+        if (n<=capacity) return;
+        size_t* grown=new size_t[n];
+        std::copy(ptr, ptr+count, grown);
+        if (ptr!=local) delete[] ptr;
+        ptr=grown;
+        capacity=n;
+    }
+
+    size_t count;
+    size_t capacity;
+    size_t* ptr;
+    size_t local[N];
+};
+
+}; //namespace reserved
+
+
+// sets the memory resource new tensors of this thread allocate from, for the lifetime of the scope.
+// The resource must outlive the tensors allocated from it
+class resource_scope {
+public:
+    explicit resource_scope(std::pmr::memory_resource* resource) : previous(reserved::current_resource()) {
+        reserved::current_resource()=resource;
+    }
+    ~resource_scope() { reserved::current_resource()=previous; }
+
+    resource_scope(const resource_scope&) = delete;
+    resource_scope& operator = (const resource_scope&) = delete;
+
+private:
+    std::pmr::memory_resource* previous;
+};
+
+
+// memory resource for the temporaries of repeated evaluations: allocations are bumped out of a
+// chunk in O(1) and deallocations only count, so that when the last live block is returned the
+// arena rewinds and the next evaluation reuses the same memory. Chunks grabbed while growing are
+// coalesced at the rewind into one chunk of the high-water size. Not thread-safe
+class arena : public std::pmr::memory_resource {
+public:
+    explicit arena(size_t initial=0, std::pmr::memory_resource* upstream=std::pmr::get_default_resource())
+            : upstream(upstream), used(0), live(0) {
+        if (initial!=0) grow(initial);
+    }
+    ~arena() {
+        assert(live==0);
+        release();
+    }
+
+    arena(const arena&) = delete;
+    arena& operator = (const arena&) = delete;
+
+    // bytes reserved from upstream
+    size_t capacity() const {
+        size_t result=0;
+        for (auto& c : chunks) result += c.size;
+        return result;
+    }
+
+    // forgets all the blocks handed out, which must not be used anymore, keeping the memory
+    void reset() {
+        live=0;
+        rewind();
+    }
+
+private:
+    struct chunk {
+        char* ptr;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t align) override {
+        if (!chunks.empty()) {
+            const chunk& c=chunks.back();
+            const std::uintptr_t base=reinterpret_cast<std::uintptr_t>(c.ptr);
+            const size_t offset=((base+used+align-1)/align*align)-base;
+            if (offset+bytes<=c.size) {
+                used=offset+bytes;
+                ++live;
+                return c.ptr+offset;
+            }
+        }
+        grow(std::max(2*(chunks.empty() ? 0 : chunks.back().size), bytes+align));
+        return do_allocate(bytes, align);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+        assert(live!=0);
+        if (--live==0) rewind();
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this==&other; }
+
+    void grow(size_t size) {
+        chunks.push_back({static_cast<char*>(upstream->allocate(size, reserved::alignment)), size});
+        used=0;
+    }
+
+    void rewind() {
+        if (chunks.size()>1) {
+            const size_t size=capacity();
+            release();
+            grow(size);
+        }
+        used=0;
+    }
+
+    void release() {
+        for (auto& c : chunks) upstream->deallocate(c.ptr, c.size, reserved::alignment);
+        chunks.clear();
+    }
+
+    std::pmr::memory_resource* upstream;
+    std::vector<chunk> chunks;
+    size_t used;
+    size_t live;
+};
+
+
+// arena that new tensors of this thread allocate from for the lifetime of the scope, e.g. around
+// the body of a loop creating the same tensors over and over. Tensors keep the resource they were
+// allocated from, so none of them may escape the scope: the arena asserts that all its blocks came
+// back when it is destroyed. The evaluation engine needs no such scope for its own temporaries,
+// which come from the scratch arenas below
+class arena_scope {
+public:
+    explicit arena_scope(size_t initial=0) : pool(initial), scope(&pool) {}
+
+    arena& get() { return pool; }
+
+private:
+    arena pool;
+    resource_scope scope;
+};
+
+
+namespace reserved {
+
+// shared pool of scratch arenas, kept across evaluations. Threads only turn to it when they nest
+// deeper than ever before, and give their arenas back when they end, see thread_arenas, so that
+// the workers of the next evaluation start from arenas grown to the high-water mark of the last
+class scratch_pool {
+public:
+    arena* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (free.empty()) {
+            arenas.emplace_back(new arena());
+            return arenas.back().get();
+        }
+        arena* result=free.back();
+        free.pop_back();
+        return result;
+    }
+
+    void release(arena* a) {
+        a->reset();
+        std::lock_guard<std::mutex> lock(mutex);
+        free.push_back(a);
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<arena>> arenas;
+    std::vector<arena*> free;
+};
+
+inline scratch_pool& scratch_arenas() {
+    static scratch_pool pool;
+    return pool;
+}
+
+// scratch arenas of one thread. Tasks nest (Strassen-Winograd runs its products as tasks of tasks,
+// recursively) and their scratches end in reverse order, so the arenas form a stack indexed by
+// the nesting depth: leasing and returning one takes no lock and touches no other thread
+class thread_arenas {
+public:
+    thread_arenas() : depth(0) {}
+    ~thread_arenas() {
+        for (arena* a : arenas) scratch_arenas().release(a);
+    }
+
+    thread_arenas(const thread_arenas&) = delete;
+    thread_arenas& operator = (const thread_arenas&) = delete;
+
+    arena* acquire() {
+        if (depth==arenas.size()) arenas.push_back(scratch_arenas().acquire());
+        return arenas[depth++];
+    }
+
+    void release(arena* a) {
+        assert(depth!=0 && arenas[depth-1]==a);
+        a->reset();
+        --depth;
+    }
+
+private:
+    std::vector<arena*> arenas;
+    size_t depth;
+};
+
+inline thread_arenas& local_arenas() {
+    static thread_local thread_arenas arenas;
+    return arenas;
+}
+
+// scratch memory of one task: partial accumulators, packed tiles, temporaries. Buffers are bumped
+// out of an arena of the running thread, which is reset but not freed when the task ends
+class scratch {
+public:
+    scratch() : pool(local_arenas().acquire()) {}
+    ~scratch() {
+        for (auto& c : cleanups) c.destroy(c.ptr, c.count);
+        local_arenas().release(pool);
+    }
+
+    scratch(const scratch&) = delete;
+    scratch& operator = (const scratch&) = delete;
+
+    // n default-initialized elements, aligned and valid until the end of the task
+    template<typename T>
+    T* get(size_t n) {
+        T* result=static_cast<T*>(pool->allocate(n*sizeof(T), alignment));
+        std::uninitialized_default_construct_n(result, n);
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            cleanups.push_back({[](void* ptr, size_t count) { std::destroy_n(static_cast<T*>(ptr), count); }, result, n});
+        }
+        return result;
+    }
+
+    // the leased arena, for the containers of the task
+    std::pmr::memory_resource* resource() { return pool; }
+
+private:
+    struct cleanup {
+        void (*destroy)(void*, size_t);
+        void* ptr;
+        size_t count;
+    };
+
+    arena* pool;
+    std::vector<cleanup> cleanups;
+};
+
+}; //namespace reserved
+
+}; //namespace Tensor
+
+#endif // STORAGE_H
@@ -66,6 +66,19 @@ int main() {
         double elapsed_time = std::chrono::duration<double>(end_time-start_time).count();
         
         std::cout << "multi-slice elapsed time: " << elapsed_time << '\n';
+    }
+    {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        auto Av=A.view();
+        for (int n=0; n!=rep; ++n) {
+            for (int i=0; i!=size; ++i)
+                for (int j=0; j!=size; ++j)
+                    Av[i][j] += 1;
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        double elapsed_time = std::chrono::duration<double>(end_time-start_time).count();
+        
+        std::cout << "view multi-slice elapsed time: " << elapsed_time << '\n';
     }
      {
         auto start_time = std::chrono::high_resolution_clock::now();
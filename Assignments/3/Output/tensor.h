@@ -8,9 +8,11 @@
 #include<type_traits>
 #include<initializer_list>
 #include<vector>
+#include<array>
 #include<algorithm>
 
 #include"tensor_fwd.h"
+#include"storage.h"
 #include"einstein.h"
 
 
@@ -220,6 +222,22 @@ template<typename head, typename...tail> struct is_integral_pack<head,tail...> {
 };
 
 
+namespace reserved {
+// tensor type of the slices of a tensor of the given type
+template<class TYPE> struct sliced { typedef TYPE type; };
+template<size_t R> struct sliced<rank<R>> { typedef rank<R-1> type; };
+
+template<class> struct is_view : std::false_type {};
+template<typename T, class type> struct is_view<tensor_view<T,type>> : std::true_type {};
+
+// the data of a new slice or window: shared by tensors, or copied if small and inline, borrowed by views
+template<typename T>
+void attach(storage<T>& to, const storage<T>& from, std::false_type) { to=from; }
+template<typename T>
+void attach(storage<T>& to, const storage<T>& from, std::true_type) { to.borrow(from); }
+}
+
+
 
 // tensor specialization for dynamic rank
 template<typename T>
@@ -228,33 +246,52 @@ public:
     // C-style constructor with explicit rank and pointer to array of dimensions
     // all other constructors are redirected to this one
     tensor(size_t rank, const size_t dimensions[]) : width(dimensions, dimensions+rank), stride(rank,1UL) {
-        for (size_t i=width.size()-1UL; i!=0; --i) stride[i-1] = stride[i]*width[i];
-        data = std::make_shared<std::vector<T>>(stride[0]*width[0]);
-        start_ptr = &(data->operator[](0));
+        data = reserved::storage<T>(reserved::layout<T>(width,stride));
+        start_ptr = data.begin();
     }
     tensor(const std::vector<size_t>& dimensions) : tensor(dimensions.size(),&dimensions[0]) {}
     tensor(std::initializer_list<size_t> dimensions) : tensor(dimensions.size(),&*dimensions.begin()) {}
+
+    // bulk load of the elements, in right-major order, from first
+    template<class InputIt>
+    tensor(const std::vector<size_t>& dimensions, InputIt first) : tensor(reserved::uninitialized, dimensions.size(), &dimensions[0]) {
+        for (auto i=begin(); i!=end(); ++i, ++first) *i = *first;
+    }
     
     template<size_t rank> tensor(const size_t dims[rank]) : tensor(rank, dims) {}
     template<typename... Dims>
     tensor(std::enable_if_t<is_integral_pack<Dims...>::value, const size_t> dim1, Dims... dims  )  : width({dim1, static_cast<const size_t>(dims)...}), stride(sizeof...(dims)+1, 1UL) {
-        for (size_t i=width.size()-1UL; i!=0UL; --i) stride[i-1] = stride[i]*width[i];
-        data = std::make_shared<std::vector<T>>(stride[0]*width[0]);
-        start_ptr = &(data->operator[](0));
+        data = reserved::storage<T>(reserved::layout<T>(width,stride));
+        start_ptr = data.begin();
     }
 
     
-    tensor(const tensor<T,dynamic>&X)=default;
-    tensor(tensor<T,dynamic>&&X)=default;
-    tensor<T,dynamic>& operator = (const tensor<T,dynamic>&X)=default;
-    tensor<T,dynamic>& operator = (tensor<T,dynamic>&&X)=default;
+    // copies and moves share heap data, and acquire shared ownership of the data of views.
+    // Small inline data is copied, as is moved, and start_ptr follows it
+    tensor(const tensor<T,dynamic>&X) : data(X.data), width(X.width), stride(X.stride), start_ptr(data.rebase(X.data,X.start_ptr)) {}
+    tensor(tensor<T,dynamic>&&X) : data(std::move(X.data)), width(std::move(X.width)), stride(std::move(X.stride)), start_ptr(data.rebase(X.data,X.start_ptr)) {}
+    tensor<T,dynamic>& operator = (const tensor<T,dynamic>&X) {
+        data=X.data;
+        width=X.width;
+        stride=X.stride;
+        start_ptr=data.rebase(X.data,X.start_ptr);
+        return *this;
+    }
+    tensor<T,dynamic>& operator = (tensor<T,dynamic>&&X) {
+        data=std::move(X.data);
+        width=std::move(X.width);
+        stride=std::move(X.stride);
+        start_ptr=data.rebase(X.data,X.start_ptr);
+        return *this;
+    }
     
     // all tensor types are friend
     // this are used by alien copy constructors, i.e. copy constructors copying different tensor types.
     template<typename, typename> friend class tensor;
+    template<typename, typename> friend class tensor_view;
     
     template<size_t R>
-    tensor(const tensor<T,rank<R>>&X) : data(X.data), width(X.width.begin(),X.width.end()), stride(X.stride.begin(),X.stride.end()), start_ptr(X.start_ptr) {}
+    tensor(const tensor<T,rank<R>>&X) : data(X.data), width(X.width.begin(),X.width.end()), stride(X.stride.begin(),X.stride.end()), start_ptr(data.rebase(X.data,X.start_ptr)) {}
     
     
     
@@ -328,43 +365,26 @@ public:
 
 
     // slice operation create a new tensor type sharing the data and removing the sliced index
-    tensor<T,dynamic> slice(size_t index, size_t i) const {
-        const size_t rank=width.size();
-        assert(index<rank);
-        tensor<T,dynamic> result;
-        result.data=data;
-        result.width.insert(result.width.end(),width.begin(),width.begin()+index);
-        result.width.insert(result.width.end(),width.begin()+index+1,width.end());
-        result.stride.insert(result.stride.end(),stride.begin(),stride.begin()+index);
-        result.stride.insert(result.stride.end(),stride.begin()+index+1,stride.end());
-        result.start_ptr = start_ptr+i*stride[index];
-
-        return result;
-    }
+    // small tensors keep their data inline, so their slices and windows are copies: use view() to write through them
+    tensor<T,dynamic> slice(size_t index, size_t i) const { return make_slice<tensor<T,dynamic>>(index,i); }
     // operator [] slices the first (leftmost) index
     tensor<T,dynamic> operator[](size_t i) const { return slice(0,i); }
 
     // window operation on a single index
     tensor<T,dynamic> window(size_t index, size_t begin, size_t end) const {
-        tensor<T,dynamic> result(*this);
-        result.width[index]=end-begin;
-        result.start_ptr += result.stride[index]*begin;
-        return result;
+        return make_window<tensor<T,dynamic>>(index,begin,end);
     }
 
     //window operations on all indices
     tensor<T,dynamic> window(const size_t begin[], const size_t end[]) const {
-        tensor<T,dynamic> result(*this);
-        const size_t r=get_rank();
-        for (int i=0; i!=r; ++i) {
-            result.width[i]=end[i]-begin[i];
-            result.start_ptr += result.stride[i]*begin[i];
-        }
-        return result;
+        return make_window<tensor<T,dynamic>>(begin,end);
     }
     tensor<T,dynamic> window(const std::vector<size_t>& begin, const std::vector<size_t>& end) const
     { return window(&(begin[0]), &(end[0])); }
 
+    // view borrowing the data of this tensor, see tensor_view
+    tensor_view<T,dynamic> view() const { return tensor_view<T,dynamic>(*this, reserved::borrow); }
+
     // flaten operation
     // do not use over windowed and sliced ranges
     tensor<T,dynamic> flatten(size_t begin, size_t end) const {
@@ -374,8 +394,8 @@ public:
         result.width.insert(result.width.end(),width.begin(),width.begin()+begin);
         result.width.insert(result.width.end(),width.begin()+end,width.end());
         for(int i=begin; i!=end; ++i) result.width[end]*=width[i];
-        result.start_prt=start_ptr;
         result.data=data;
+        result.start_prt=start_ptr;
         return result;
     }
 
@@ -421,8 +441,58 @@ public:
 
 private:
     tensor()=default;
+
+    // view of the data of X, see tensor_view
+    tensor(const tensor<T,dynamic>&X, reserved::borrow_t) : width(X.width), stride(X.stride), start_ptr(X.start_ptr) { data.borrow(X.data); }
+
+    // slices and windows: RESULT is a tensor sharing the data or a view borrowing it
+    template<class RESULT>
+    RESULT make_slice(size_t index, size_t i) const {
+        const size_t rank=width.size();
+        assert(index<rank);
+        RESULT result;
+        reserved::attach(result.data, data, reserved::is_view<RESULT>());
+        result.width.insert(result.width.end(),width.begin(),width.begin()+index);
+        result.width.insert(result.width.end(),width.begin()+index+1,width.end());
+        result.stride.insert(result.stride.end(),stride.begin(),stride.begin()+index);
+        result.stride.insert(result.stride.end(),stride.begin()+index+1,stride.end());
+        result.start_ptr = result.data.rebase(data,start_ptr)+i*stride[index];
+
+        return result;
+    }
+    template<class RESULT>
+    RESULT make_window(size_t index, size_t begin, size_t end) const {
+        RESULT result;
+        reserved::attach(result.data, data, reserved::is_view<RESULT>());
+        result.width=width;
+        result.stride=stride;
+        result.width[index]=end-begin;
+        result.start_ptr = result.data.rebase(data,start_ptr) + stride[index]*begin;
+        return result;
+    }
+    template<class RESULT>
+    RESULT make_window(const size_t begin[], const size_t end[]) const {
+        RESULT result;
+        reserved::attach(result.data, data, reserved::is_view<RESULT>());
+        result.width=width;
+        result.stride=stride;
+        result.start_ptr=result.data.rebase(data,start_ptr);
+        const size_t r=get_rank();
+        for (int i=0; i!=r; ++i) {
+            result.width[i]=end[i]-begin[i];
+            result.start_ptr += result.stride[i]*begin[i];
+        }
+        return result;
+    }
+
+    // construction for the engine and bulk loads, which write every element before exposing the tensor
+    tensor(reserved::uninitialized_t, size_t rank, const size_t dimensions[]) : width(dimensions, dimensions+rank), stride(rank,1UL) {
+        data = reserved::storage<T>(reserved::layout<T>(width,stride), reserved::uninitialized);
+        start_ptr = data.begin();
+    }
+    tensor(reserved::uninitialized_t, const dynamic::width_type& dimensions) : tensor(reserved::uninitialized, dimensions.size(), &dimensions[0]) {}
     
-    std::shared_ptr<std::vector<T>> data;
+    reserved::storage<T> data;
     dynamic::width_type width;
     dynamic::index_type stride;
     T* start_ptr;
@@ -445,40 +515,57 @@ class tensor<T, rank<R>> {
 public:
     // C-style constructor with implicit rank and pointer to array of dimensions
     // all other constructors are redirected to this one
-    tensor(const size_t dimensions[R]) : width(dimensions, dimensions+R), stride(R,1UL) {
-        size_t *wptr=&(width[0]), *endp=&(width[0])+R;
-        while (wptr!=endp) *(wptr++) = *(dimensions++);
-        stride[R-1]=1UL;
-        for (int i=R-1; i!=0; --i) {
-            stride[i-1] = stride[i]*width[i];
-        }
-        data = std::make_shared<std::vector<T>>(stride[0]*width[0]);
-        start_ptr = &(data->operator[](0));
+    tensor(const size_t dimensions[R]) {
+        std::copy(dimensions, dimensions+R, width.begin());
+        data = reserved::storage<T>(reserved::layout<T>(width,stride));
+        start_ptr = data.begin();
     }
     
     tensor(const std::vector<size_t>& dimensions) : tensor(&dimensions[0]) { assert(dimensions.size()==R); }
+    tensor(const typename rank<R>::width_type& dimensions) : tensor(&dimensions[0]) {}
+
+    // bulk load of the elements, in right-major order, from first
+    template<class InputIt>
+    tensor(const typename rank<R>::width_type& dimensions, InputIt first) : tensor(reserved::uninitialized, dimensions) {
+        for (auto i=begin(); i!=end(); ++i, ++first) *i = *first;
+    }
 
     template<typename... Dims>
-    tensor(std::enable_if_t<is_integral_pack<Dims...>::value,const size_t> dim1, Dims... dims  ) : width({dim1, static_cast<const size_t>(dims)...}), stride(R, 1UL) {
+    tensor(std::enable_if_t<is_integral_pack<Dims...>::value,const size_t> dim1, Dims... dims  ) : width{{dim1, static_cast<const size_t>(dims)...}} {
         static_assert(sizeof...(dims)==R-1, "size mismatch");
         
-        stride[R-1]=1UL;
-        for (size_t i=R-1UL; i!=0UL; --i) {
-            stride[i-1] = stride[i]*width[i];
-        }
-        data = std::make_shared<std::vector<T>>(stride[0]*width[0]);
-        start_ptr = &(data->operator[](0));
+        data = reserved::storage<T>(reserved::layout<T>(width,stride));
+        start_ptr = data.begin();
     }
     
-    tensor(const tensor<T,rank<R>>&X) = default;
-    tensor(tensor<T,rank<R>>&&X) = default;
+    // copies and moves share heap data, and acquire shared ownership of the data of views.
+    // Small inline data is copied, as is moved, and start_ptr follows it
+    tensor(const tensor<T,rank<R>>&X) : data(X.data), width(X.width), stride(X.stride), start_ptr(data.rebase(X.data,X.start_ptr)) {}
+    tensor(tensor<T,rank<R>>&&X) : data(std::move(X.data)), width(X.width), stride(X.stride), start_ptr(data.rebase(X.data,X.start_ptr)) {}
+    tensor<T,rank<R>>& operator = (const tensor<T,rank<R>>&X) {
+        data=X.data;
+        width=X.width;
+        stride=X.stride;
+        start_ptr=data.rebase(X.data,X.start_ptr);
+        return *this;
+    }
+    tensor<T,rank<R>>& operator = (tensor<T,rank<R>>&&X) {
+        data=std::move(X.data);
+        width=X.width;
+        stride=X.stride;
+        start_ptr=data.rebase(X.data,X.start_ptr);
+        return *this;
+    }
     
     // all tensor types are friend
     // this are used by alien copy constructors, i.e. copy constructors copying different tensor types.
     template<typename, typename> friend class tensor;
+    template<typename, typename> friend class tensor_view;
     
-    tensor(const tensor<T,dynamic>& X) : data(X.data), width(X.width.begin(),X.width.end()), stride(X.stride.begin(),X.stride.end()), start_ptr(X.start_ptr){
+    tensor(const tensor<T,dynamic>& X) : data(X.data), start_ptr(data.rebase(X.data,X.start_ptr)){
         assert(X.get_rank()==R);
+        std::copy(X.width.begin(), X.width.end(), width.begin());
+        std::copy(X.stride.begin(), X.stride.end(), stride.begin());
     }
 
 
@@ -512,17 +599,20 @@ public:
     }
 
     // could use std::enable_if rather than static assert!
+    // indices go through a stack array, never through a temporary vector
     template<typename...Dims>
     typename std::enable_if<is_integral_pack<Dims...>::value,T&>::type
     operator()(Dims...dimensions) const {
         static_assert(sizeof...(dimensions)==R, "rank mismatch");
-        return operator()({static_cast<const size_t>(dimensions)...});
+        const size_t idx[R] = {static_cast<const size_t>(dimensions)...};
+        return operator()(idx);
     }
     template<typename...Dims>
     typename std::enable_if<is_integral_pack<Dims...>::value,T&>::type
     at(Dims...dimensions) const {
         static_assert(sizeof...(dimensions)==R, "rank mismatch");
-        return at({static_cast<const size_t>(dimensions)...});
+        const size_t idx[R] = {static_cast<const size_t>(dimensions)...};
+        return at(idx);
     }
     
 
@@ -571,55 +661,25 @@ public:
         return index_iterator(stride[index], &operator()(dimensions) + (width[index]-dimensions[index])*stride[index]);
     }
 
-    // slicing operations return lower-rank tensors
-    tensor<T, rank<R-1>> slice(size_t index, size_t n) const {
-        assert(index<R);
-        tensor<T, rank<R-1>> result;
-
-        result.data=data;
-        result.width.insert(result.width.end(),width.begin(),width.begin()+index);
-        result.width.insert(result.width.end(),width.begin()+index+1,width.end());
-        result.stride.insert(result.stride.end(),stride.begin(),stride.begin()+index);
-        result.stride.insert(result.stride.end(),stride.begin()+index+1,stride.end());
-        result.start_ptr = start_ptr+n*stride[index];
-
-        /*
-        result.data=data;
-        for (size_t i=0; i!=index; ++i) {
-            result.width[i] = width[i];
-            result.stride[i] = stride[i];
-        }
-        for (size_t i=index; i!=R-1U; ++i) {
-            result.width[i] = width[i+1];
-            result.stride[i] = stride[i+1];
-        }
-        result.start_ptr = start_ptr+n*stride[index];
-        */
-
-        return result;
-    }
+    // slicing operations return lower-rank tensors sharing the data, or copying small inline data
+    tensor<T, rank<R-1>> slice(size_t index, size_t n) const { return make_slice<tensor<T,rank<R-1>>>(index,n); }
     tensor<T, rank<R-1>> operator[](size_t i) const { return slice(0,i); }
 
 
     // window operations do not change rank
     tensor<T,rank<R>> window(size_t index, size_t begin, size_t end) const {
-        tensor<T,rank<R>> result(*this);
-        result.width[index]=end-begin;
-        result.start_ptr += result.stride[index]*begin;
-        return result;
+        return make_window<tensor<T,rank<R>>>(index,begin,end);
     }
 
     tensor<T,rank<R>> window(const size_t begin[], const size_t end[]) const {
-        tensor<T,rank<R>> result(*this);
-        for (size_t i=0; i!=R; ++i) {
-            result.width[i]=end[i]-begin[i];
-            result.start_ptr += result.stride[i]*begin[i];
-        }
-        return result;
+        return make_window<tensor<T,rank<R>>>(begin,end);
     }
     tensor<T,dynamic> window(const std::vector<size_t>& begin, const std::vector<size_t>& end) const
     { return window(&begin[0], &end[0]); }
 
+    // view borrowing the data of this tensor, see tensor_view
+    tensor_view<T,rank<R>> view() const { return tensor_view<T,rank<R>>(*this, reserved::borrow); }
+
     // flatten operations change rank in a way that is not known at compile time
     // would need a different interface to provide that info at compile time,
     // but the operation should not be time-critical
@@ -630,8 +690,8 @@ public:
         result.width.insert(result.width.end(),width.begin(),width.begin()+begin);
         result.stride.insert(result.stride.end(),stride.begin()+end,stride.end());
         for(size_t i=begin; i!=end; ++i) result.width[end]*=width[i];
-        result.start_prt=start_ptr;
         result.data=data;
+        result.start_prt=start_ptr;
         return result;
     }
 
@@ -640,8 +700,60 @@ public:
 private:    
     
     tensor() = default;
+
+    // view of the data of X, see tensor_view
+    tensor(const tensor<T,rank<R>>&X, reserved::borrow_t) : width(X.width), stride(X.stride), start_ptr(X.start_ptr) { data.borrow(X.data); }
+
+    // slices and windows: RESULT is a tensor sharing the data or a view borrowing it
+    template<class RESULT>
+    RESULT make_slice(size_t index, size_t n) const {
+        assert(index<R);
+        RESULT result;
+
+        reserved::attach(result.data, data, reserved::is_view<RESULT>());
+        for (size_t i=0; i!=index; ++i) {
+            result.width[i] = width[i];
+            result.stride[i] = stride[i];
+        }
+        for (size_t i=index; i!=R-1U; ++i) {
+            result.width[i] = width[i+1];
+            result.stride[i] = stride[i+1];
+        }
+        result.start_ptr = result.data.rebase(data,start_ptr)+n*stride[index];
+
+        return result;
+    }
+    template<class RESULT>
+    RESULT make_window(size_t index, size_t begin, size_t end) const {
+        RESULT result;
+        reserved::attach(result.data, data, reserved::is_view<RESULT>());
+        result.width=width;
+        result.stride=stride;
+        result.width[index]=end-begin;
+        result.start_ptr = result.data.rebase(data,start_ptr) + stride[index]*begin;
+        return result;
+    }
+    template<class RESULT>
+    RESULT make_window(const size_t begin[], const size_t end[]) const {
+        RESULT result;
+        reserved::attach(result.data, data, reserved::is_view<RESULT>());
+        result.width=width;
+        result.stride=stride;
+        result.start_ptr=result.data.rebase(data,start_ptr);
+        for (size_t i=0; i!=R; ++i) {
+            result.width[i]=end[i]-begin[i];
+            result.start_ptr += result.stride[i]*begin[i];
+        }
+        return result;
+    }
+
+    // construction for the engine and bulk loads, which write every element before exposing the tensor
+    tensor(reserved::uninitialized_t, const typename rank<R>::width_type& dimensions) : width(dimensions) {
+        data = reserved::storage<T>(reserved::layout<T>(width,stride), reserved::uninitialized);
+        start_ptr = data.begin();
+    }
     
-    std::shared_ptr<std::vector<T>> data;
+    reserved::storage<T> data;
     typename rank<R>::width_type width;
     typename rank<R>::index_type stride;
     T* start_ptr;
@@ -666,14 +778,41 @@ template<typename T>
 class tensor<T, rank<1>>  {
 public:
 
-    tensor(size_t dimension) : width(1, dimension), stride(1,1UL){
-        data=std::make_shared<std::vector<T>>(dimension);
-        start_ptr = &*(data->begin());
+    tensor(size_t dimension) : width{{dimension}}, stride{{1UL}}{
+        data=reserved::storage<T>(dimension);
+        start_ptr = data.begin();
+    }
+    tensor(const rank<1>::width_type& dimensions) : tensor(dimensions[0]) {}
+
+    // bulk load of the elements from first
+    template<class InputIt>
+    tensor(size_t dimension, InputIt first) : tensor(reserved::uninitialized, rank<1>::width_type{{dimension}}) {
+        std::copy_n(first, dimension, start_ptr);
+    }
+
+    // copies and moves share heap data, and acquire shared ownership of the data of views.
+    // Small inline data is copied, as is moved, and start_ptr follows it
+    tensor(const tensor<T,rank<1>>&X) : data(X.data), width(X.width), stride(X.stride), start_ptr(data.rebase(X.data,X.start_ptr)) {}
+    tensor(tensor<T,rank<1>>&&X) : data(std::move(X.data)), width(X.width), stride(X.stride), start_ptr(data.rebase(X.data,X.start_ptr)) {}
+    tensor<T,rank<1>>& operator = (const tensor<T,rank<1>>&X) {
+        data=X.data;
+        width=X.width;
+        stride=X.stride;
+        start_ptr=data.rebase(X.data,X.start_ptr);
+        return *this;
+    }
+    tensor<T,rank<1>>& operator = (tensor<T,rank<1>>&&X) {
+        data=std::move(X.data);
+        width=X.width;
+        stride=X.stride;
+        start_ptr=data.rebase(X.data,X.start_ptr);
+        return *this;
     }
     
     // all tensor types are friend
     // this are used by alien copy constructors, i.e. copy constructors copying different tensor types.
     template<typename, typename> friend class tensor;
+    template<typename, typename> friend class tensor_view;
     
     constexpr size_t get_rank() const { return 1; }
     
@@ -722,12 +861,10 @@ public:
     }
     T& operator[](size_t i)  { return *(start_ptr+i*stride[0]); }
 
-    tensor<T,rank<1>> window(size_t begin, size_t end) const {
-        tensor<T,rank<1>> result(*this);
-        result.width[0]=end-begin;
-        result.start_ptr += result.stride[0]*begin;
-        return result;
-    }
+    tensor<T,rank<1>> window(size_t begin, size_t end) const { return make_window<tensor<T,rank<1>>>(begin,end); }
+
+    // view borrowing the data of this tensor, see tensor_view
+    tensor_view<T,rank<1>> view() const { return tensor_view<T,rank<1>>(*this, reserved::borrow); }
 
 
     typedef T* iterator;
@@ -739,7 +876,27 @@ public:
 private:    
     
     tensor() = default;
-    std::shared_ptr<std::vector<T>> data;
+
+    // view of the data of X, see tensor_view
+    tensor(const tensor<T,rank<1>>&X, reserved::borrow_t) : width(X.width), stride(X.stride), start_ptr(X.start_ptr) { data.borrow(X.data); }
+
+    // window into a tensor sharing the data or a view borrowing it
+    template<class RESULT>
+    RESULT make_window(size_t begin, size_t end) const {
+        RESULT result;
+        reserved::attach(result.data, data, reserved::is_view<RESULT>());
+        result.width[0]=end-begin;
+        result.stride=stride;
+        result.start_ptr = result.data.rebase(data,start_ptr) + stride[0]*begin;
+        return result;
+    }
+
+    // construction for the engine and bulk loads, which write every element before exposing the tensor
+    tensor(reserved::uninitialized_t, const rank<1>::width_type& dimensions) : width(dimensions), stride{{1UL}} {
+        data = reserved::storage<T>(dimensions[0], reserved::uninitialized);
+        start_ptr = data.begin();
+    }
+    reserved::storage<T> data;
     rank<1>::width_type width;
     rank<1>::index_type stride;
     T* start_ptr;
@@ -747,6 +904,138 @@ private:
 
 
 
+
+// non-owning tensor returned by view()
+// a view borrows the data of the tensor it comes from without touching its reference count, so
+// slicing it in hot loops costs no atomic operations. As std::string_view, it must not outlive the
+// tensors owning that data. Slices and windows of a view are views, copies of a view are views and
+// assignment rebinds them; converting a view to a tensor acquires shared ownership of the data, or
+// copies it if it is small and inline. Views are the way to write through slices of small tensors.
+// Tensors themselves keep returning tensors sharing the data, so borrowing is always explicit
+template<typename T, class type>
+class tensor_view : public tensor<T,type> {
+public:
+    tensor_view(const tensor_view<T,type>& X) : tensor<T,type>(X, reserved::borrow) {}
+    tensor_view<T,type>& operator = (const tensor_view<T,type>& X) {
+        this->data.borrow(X.data);
+        this->width=X.width;
+        this->stride=X.stride;
+        this->start_ptr=X.start_ptr;
+        return *this;
+    }
+
+    tensor_view<T,typename reserved::sliced<type>::type> slice(size_t index, size_t i) const {
+        return this->template make_slice<tensor_view<T,typename reserved::sliced<type>::type>>(index,i);
+    }
+    tensor_view<T,typename reserved::sliced<type>::type> operator[](size_t i) const { return slice(0,i); }
+
+    tensor_view<T,type> window(size_t index, size_t begin, size_t end) const {
+        return this->template make_window<tensor_view<T,type>>(index,begin,end);
+    }
+    tensor_view<T,type> window(const size_t begin[], const size_t end[]) const {
+        return this->template make_window<tensor_view<T,type>>(begin,end);
+    }
+    tensor_view<T,type> window(const std::vector<size_t>& begin, const std::vector<size_t>& end) const
+    { return window(&begin[0], &end[0]); }
+
+    template<typename, typename> friend class tensor;
+private:
+    tensor_view() = default;
+    tensor_view(const tensor<T,type>& X, reserved::borrow_t) : tensor<T,type>(X, reserved::borrow) {}
+};
+
+// views of rank 1 slice to elements, as the tensors
+template<typename T>
+class tensor_view<T,rank<1>> : public tensor<T,rank<1>> {
+public:
+    tensor_view(const tensor_view<T,rank<1>>& X) : tensor<T,rank<1>>(X, reserved::borrow) {}
+    tensor_view<T,rank<1>>& operator = (const tensor_view<T,rank<1>>& X) {
+        this->data.borrow(X.data);
+        this->width=X.width;
+        this->stride=X.stride;
+        this->start_ptr=X.start_ptr;
+        return *this;
+    }
+
+    tensor_view<T,rank<1>> window(size_t begin, size_t end) const {
+        return this->template make_window<tensor_view<T,rank<1>>>(begin,end);
+    }
+
+    template<typename, typename> friend class tensor;
+private:
+    tensor_view() = default;
+    tensor_view(const tensor<T,rank<1>>& X, reserved::borrow_t) : tensor<T,rank<1>>(X, reserved::borrow) {}
+};
+
+
+
+
+
+
+
+
+
+// tensor specialization for fixed shape
+// dimensions are template parameters and the elements are stored inline, so these tensors never
+// touch the heap. Copies are deep, as for std::array and for small dynamic and ranked tensors
+template<typename T, size_t... D>
+class tensor<T, fixed<D...>> {
+public:
+    static_assert(sizeof...(D)>0, "fixed-shape tensors need at least one dimension");
+
+    tensor() : data() {}
+
+    constexpr size_t get_rank() const { return sizeof...(D); }
+    static constexpr size_t size() { return (D * ...); }
+
+    // direct accessors: the offset computation has a constant trip count and gets fully unrolled
+    template<typename...Dims>
+    typename std::enable_if<is_integral_pack<Dims...>::value,T&>::type
+    operator()(Dims...dimensions) {
+        static_assert(sizeof...(dimensions)==sizeof...(D), "rank mismatch");
+        return data[offset({static_cast<size_t>(dimensions)...})];
+    }
+    template<typename...Dims>
+    typename std::enable_if<is_integral_pack<Dims...>::value,const T&>::type
+    operator()(Dims...dimensions) const {
+        static_assert(sizeof...(dimensions)==sizeof...(D), "rank mismatch");
+        return data[offset({static_cast<size_t>(dimensions)...})];
+    }
+    template<typename...Dims>
+    typename std::enable_if<is_integral_pack<Dims...>::value,T&>::type
+    at(Dims...dimensions) {
+        static_assert(sizeof...(dimensions)==sizeof...(D), "rank mismatch");
+        const size_t idx[] = {static_cast<size_t>(dimensions)...};
+        for (size_t i=0; i!=sizeof...(D); ++i) assert(idx[i]<width[i]);
+        return data[offset({static_cast<size_t>(dimensions)...})];
+    }
+
+    template<unsigned... ids>
+    fixed_expression<T, Index_Set<ids...>, fixed<D...>> operator()(StaticIndex<ids>...) {
+        static_assert(sizeof...(ids)==sizeof...(D), "rank mismatch");
+        return fixed_expression<T, Index_Set<ids...>, fixed<D...>>(&data[0]);
+    }
+
+    typedef T* iterator;
+    iterator begin() { return &data[0]; }
+    iterator end() { return &data[0] + size(); }
+    const T* begin() const { return &data[0]; }
+    const T* end() const { return &data[0] + size(); }
+
+private:
+    static constexpr size_t width[] = {D...};
+
+    static size_t offset(const std::array<size_t,sizeof...(D)>& idx) {
+        size_t result=0;
+        for (size_t i=0; i!=sizeof...(D); ++i) result = result*width[i] + idx[i];
+        return result;
+    }
+
+    std::array<T, (D * ...)> data;
+};
+
+
+
 }; //namespace tensor
 
 #endif //TENSOR
@@ -4,26 +4,36 @@
 
 namespace Tensor {
 
+namespace reserved { template<size_t N> class shape; }
 
 // policy for dynamically ranked tensors
+// shapes of up to 8 indices are stored inline, so small dynamic tensors never allocate them
 struct dynamic {
-    typedef std::vector<size_t> index_type;
-    typedef std::vector<size_t> width_type;
+    typedef reserved::shape<8> index_type;
+    typedef reserved::shape<8> width_type;
 };
 
 // policy for fixed-rank tensors
+// the shape is stored inline, so ranked tensors, their slices and iterators never allocate it
 template<size_t R> struct rank {
-    //typedef std::array<size_t,R> index_type;
-    //typedef std::array<size_t,R> width_type;
-    typedef std::vector<size_t> index_type;
-    typedef std::vector<size_t> width_type;
+    typedef std::array<size_t,R> index_type;
+    typedef std::array<size_t,R> width_type;
 };
 
 
+// policy for tensors whose whole shape is known at compile time
+template<size_t... D> struct fixed {
+    typedef std::array<size_t,sizeof...(D)> index_type;
+    typedef std::array<size_t,sizeof...(D)> width_type;
+};
+
 
 // tensor type
 template<typename T, class type=dynamic> class tensor;
 
+// non-owning view of the data of a tensor
+template<typename T, class type=dynamic> class tensor_view;
+
 
 };
 